@@ -0,0 +1,317 @@
+/*
+ *  File: AddressCache.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "PeImage.hpp"
+#include "SignaturePattern.hpp"
+
+//
+// Persistent cache of the addresses the signatures were found at
+//
+// The game executable rarely changes, so the RVAs resolved on one start are stored
+// next to the DLL and only checked on the next one. The cache belongs to a single
+// build of the executable, identified by its PE timestamp, image size and a checksum
+// of its code.
+//
+// Layout, all values are stored little endian:
+//   AddressCacheHeader
+//   AddressCacheEntry[]
+//
+
+inline constexpr uint32_t ADDRESS_CACHE_MAGIC   = 0x43415652; // "RVAC"
+inline constexpr uint32_t ADDRESS_CACHE_VERSION = 1;
+
+struct ImageFingerprint
+{
+	uint32_t timeDateStamp = 0;
+	uint32_t sizeOfImage   = 0;
+	uint64_t codeChecksum  = 0;
+
+	bool operator==(const ImageFingerprint& other) const
+	{
+		return timeDateStamp == other.timeDateStamp && sizeOfImage == other.sizeOfImage && codeChecksum == other.codeChecksum;
+	}
+
+	bool operator!=(const ImageFingerprint& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+struct AddressCacheHeader
+{
+	uint32_t magic   = ADDRESS_CACHE_MAGIC;
+	uint32_t version = ADDRESS_CACHE_VERSION;
+	ImageFingerprint fingerprint;
+	uint32_t entryCount = 0;
+	uint32_t reserved   = 0;
+};
+
+struct AddressCacheEntry
+{
+	uint64_t key; // Hash of the pattern and the section it is searched in
+	uint32_t rva;
+	uint32_t reserved;
+};
+
+static_assert(sizeof(AddressCacheHeader) == 32, "Unexpected address cache header size");
+static_assert(sizeof(AddressCacheEntry) == 16, "Unexpected address cache entry size");
+
+class AddressCache
+{
+	static constexpr uint64_t FNV_OFFSET = 0xCBF29CE484222325ull;
+	static constexpr uint64_t FNV_PRIME  = 0x100000001B3ull;
+
+	static constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ull;
+	static constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+	static constexpr uint64_t PRIME_3 = 0x165667B19E3779F9ull;
+
+public:
+	static constexpr uint32_t NOT_FOUND = static_cast<uint32_t>(-1);
+
+	//
+	// Fingerprint of an executable on disk. The code of the loaded module can not be
+	// used, the loader applied the relocations to it. Returns false if the file can
+	// not be read or is no PE image.
+	//
+	static bool ReadFingerprint(const std::filesystem::path& path, ImageFingerprint& fingerprint)
+	{
+		MappedFile file;
+		if (!file.Open(path))
+			return false;
+
+		try
+		{
+			fingerprint = GetFingerprint(PeImage(reinterpret_cast<const uint8_t*>(file.GetData()), file.GetSize(), PeLayout::File));
+		}
+		catch (const std::runtime_error&)
+		{
+			return false;
+		}
+
+		return true;
+	}
+
+	static ImageFingerprint GetFingerprint(const PeImage& image)
+	{
+		ImageFingerprint fingerprint;
+		fingerprint.timeDateStamp = image.GetTimeDateStamp();
+		fingerprint.sizeOfImage   = image.GetSizeOfImage();
+		fingerprint.codeChecksum  = FNV_OFFSET;
+
+		for (const PeSection& section : image.GetSections())
+		{
+			if (section.IsExecutable())
+				fingerprint.codeChecksum = checksum(image.GetSectionData(section), image.GetSectionSize(section), fingerprint.codeChecksum);
+		}
+
+		return fingerprint;
+	}
+
+	//
+	// Load the cache written for the executable with the fingerprint. Returns false
+	// if there is none or it belongs to another build, the cache is empty then.
+	//
+	bool Load(const std::filesystem::path& path, const ImageFingerprint& fingerprint)
+	{
+		m_fingerprint = fingerprint;
+		m_rvas.clear();
+		m_modified = false;
+
+		std::ifstream fs(path, std::ios::binary);
+		if (!fs)
+			return false;
+
+		AddressCacheHeader header;
+		if (!fs.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			return false;
+
+		if (header.magic != ADDRESS_CACHE_MAGIC || header.version != ADDRESS_CACHE_VERSION || header.fingerprint != fingerprint)
+			return false;
+
+		// Guards against truncated files and bogus counts before anything is allocated
+		std::error_code ec;
+		if (std::filesystem::file_size(path, ec) != sizeof(header) + header.entryCount * static_cast<uintmax_t>(sizeof(AddressCacheEntry)) || ec)
+			return false;
+
+		std::vector<AddressCacheEntry> entries(header.entryCount);
+		if (!fs.read(reinterpret_cast<char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(AddressCacheEntry))))
+			return false;
+
+		for (const AddressCacheEntry& entry : entries)
+			m_rvas[entry.key] = entry.rva;
+
+		return true;
+	}
+
+	// Written to a temporary file first, so a game started at the same time never sees half a cache
+	bool Save(const std::filesystem::path& path)
+	{
+		AddressCacheHeader header;
+		header.fingerprint = m_fingerprint;
+		header.entryCount  = static_cast<uint32_t>(m_rvas.size());
+
+		std::vector<AddressCacheEntry> entries;
+		entries.reserve(m_rvas.size());
+
+		for (const auto& [key, rva] : m_rvas)
+			entries.push_back({ key, rva, 0 });
+
+		std::filesystem::path tempPath = path;
+		tempPath += ".tmp";
+
+		{
+			std::ofstream fs(tempPath, std::ios::binary | std::ios::trunc);
+			if (!fs)
+				return false;
+
+			fs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			fs.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(AddressCacheEntry)));
+
+			if (!fs.flush())
+				return false;
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tempPath, path, ec);
+		if (ec)
+		{
+			std::filesystem::remove(tempPath, ec);
+			return false;
+		}
+
+		m_modified = false;
+		return true;
+	}
+
+	// Returns the cached RVA of the pattern or NOT_FOUND, the caller has to check it still matches
+	uint32_t Find(const SignaturePattern& pattern, const std::string& section) const
+	{
+		const auto it = m_rvas.find(getKey(pattern, section));
+		return it != m_rvas.end() ? it->second : NOT_FOUND;
+	}
+
+	void Set(const SignaturePattern& pattern, const std::string& section, const uint32_t& rva)
+	{
+		uint32_t& cachedRva = m_rvas.try_emplace(getKey(pattern, section), NOT_FOUND).first->second;
+		if (cachedRva == rva)
+			return;
+
+		cachedRva  = rva;
+		m_modified = true;
+	}
+
+	std::size_t Size() const
+	{
+		return m_rvas.size();
+	}
+
+	// True if addresses were added or changed since the cache was loaded or saved
+	bool IsModified() const
+	{
+		return m_modified;
+	}
+
+	const ImageFingerprint& GetFingerprint() const
+	{
+		return m_fingerprint;
+	}
+
+private:
+	static uint64_t getKey(const SignaturePattern& pattern, const std::string& section)
+	{
+		uint64_t hash = FNV_OFFSET;
+		const auto hashByte = [&hash](const uint8_t& value) {
+			hash ^= value;
+			hash *= FNV_PRIME;
+		};
+
+		// The null terminator separates the section name from the pattern
+		for (const char& c : section)
+			hashByte(static_cast<uint8_t>(c));
+		hashByte(0);
+
+		for (std::size_t i = 0; i < pattern.Size(); i++)
+		{
+			hashByte(pattern.GetBytes()[i]);
+			hashByte(pattern.GetMask()[i]);
+		}
+
+		return hash;
+	}
+
+	static uint64_t rotateLeft(const uint64_t& value, const int& count)
+	{
+		return (value << count) | (value >> (64 - count));
+	}
+
+	// Fast non-cryptographic checksum, the code sections are hashed 32 bytes at a time
+	static uint64_t checksum(const uint8_t* pData, const std::size_t& size, const uint64_t& seed)
+	{
+		// Four independent lanes, so the multiplications do not wait on each other
+		uint64_t lanes[4] = { seed + PRIME_1, seed + PRIME_2, seed, seed - PRIME_1 };
+		std::size_t i     = 0;
+
+		for (; i + 32 <= size; i += 32)
+		{
+			for (std::size_t lane = 0; lane < 4; lane++)
+			{
+				uint64_t word;
+				std::memcpy(&word, pData + i + lane * 8, sizeof(word));
+				lanes[lane] = rotateLeft(lanes[lane] + word * PRIME_2, 31) * PRIME_1;
+			}
+		}
+
+		uint64_t hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) + rotateLeft(lanes[3], 18);
+		hash ^= size;
+
+		for (; i < size; i++)
+			hash = (hash ^ pData[i]) * FNV_PRIME;
+
+		hash ^= hash >> 33;
+		hash *= PRIME_3;
+		hash ^= hash >> 29;
+		return hash;
+	}
+
+private:
+	ImageFingerprint m_fingerprint;
+	std::unordered_map<uint64_t, uint32_t> m_rvas;
+	bool m_modified = false;
+};
@@ -0,0 +1,219 @@
+/*
+ *  File: AsciiRun.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "CpuFeatures.hpp"
+
+//
+// Fast path of the text conversions for runs of ASCII characters, which are the same
+// in CP932, UTF-8 and UTF-16 apart from their width. Every function handles the run
+// at the start of the source and returns its length, the caller converts the first
+// non-ASCII character and continues from there. Blocks of 16 or 32 characters are
+// checked at once with SSE2 or AVX2 if the CPU supports them.
+//
+class AsciiRun
+{
+public:
+	// Copy the ASCII bytes at the start of the source
+	static std::size_t Copy(const char* pSrc, const std::size_t& size, char* pDst)
+	{
+		std::size_t i = 0;
+
+#if CPU_FEATURES_X86
+		if (size >= 16)
+		{
+			const CpuFeatures& features = CpuFeatures::Get();
+			if (features.avx2)
+				i = copyAvx2(pSrc, size, pDst);
+			else if (features.sse2)
+				i = copySse2(pSrc, size, pDst, 0);
+		}
+#endif
+
+		for (; i < size && static_cast<uint8_t>(pSrc[i]) < 0x80; i++)
+			pDst[i] = pSrc[i];
+
+		return i;
+	}
+
+	// Widen the ASCII bytes at the start of the source to UTF-16
+	static std::size_t Widen(const char* pSrc, const std::size_t& size, char16_t* pDst)
+	{
+		std::size_t i = 0;
+
+#if CPU_FEATURES_X86
+		if (size >= 16)
+		{
+			const CpuFeatures& features = CpuFeatures::Get();
+			if (features.avx2)
+				i = widenAvx2(pSrc, size, pDst);
+			else if (features.sse2)
+				i = widenSse2(pSrc, size, pDst, 0);
+		}
+#endif
+
+		for (; i < size && static_cast<uint8_t>(pSrc[i]) < 0x80; i++)
+			pDst[i] = static_cast<char16_t>(pSrc[i]);
+
+		return i;
+	}
+
+	// Narrow the ASCII characters at the start of the UTF-16 source to bytes
+	static std::size_t Narrow(const char16_t* pSrc, const std::size_t& size, char* pDst)
+	{
+		std::size_t i = 0;
+
+#if CPU_FEATURES_X86
+		if (size >= 16)
+		{
+			const CpuFeatures& features = CpuFeatures::Get();
+			if (features.avx2)
+				i = narrowAvx2(pSrc, size, pDst);
+			else if (features.sse2)
+				i = narrowSse2(pSrc, size, pDst, 0);
+		}
+#endif
+
+		for (; i < size && pSrc[i] < 0x80; i++)
+			pDst[i] = static_cast<char>(pSrc[i]);
+
+		return i;
+	}
+
+private:
+#if CPU_FEATURES_X86
+	//
+	// The vector functions stop at the first block with a non-ASCII character and return
+	// where it starts, the rest of the run is left to the scalar loop. The AVX2 ones pass
+	// the remainder of less than 32 characters on to the SSE2 ones.
+	//
+
+	TARGET_SSE2 static std::size_t copySse2(const char* pSrc, const std::size_t& size, char* pDst, std::size_t i)
+	{
+		for (; i + 16 <= size; i += 16)
+		{
+			const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+			if (_mm_movemask_epi8(data) != 0)
+				break;
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), data);
+		}
+
+		return i;
+	}
+
+	TARGET_AVX2 static std::size_t copyAvx2(const char* pSrc, const std::size_t& size, char* pDst)
+	{
+		std::size_t i = 0;
+		for (; i + 32 <= size; i += 32)
+		{
+			const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + i));
+			if (_mm256_movemask_epi8(data) != 0)
+				return i;
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i), data);
+		}
+
+		return copySse2(pSrc, size, pDst, i);
+	}
+
+	TARGET_SSE2 static std::size_t widenSse2(const char* pSrc, const std::size_t& size, char16_t* pDst, std::size_t i)
+	{
+		const __m128i zero = _mm_setzero_si128();
+
+		for (; i + 16 <= size; i += 16)
+		{
+			const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+			if (_mm_movemask_epi8(data) != 0)
+				break;
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), _mm_unpacklo_epi8(data, zero));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i + 8), _mm_unpackhi_epi8(data, zero));
+		}
+
+		return i;
+	}
+
+	TARGET_AVX2 static std::size_t widenAvx2(const char* pSrc, const std::size_t& size, char16_t* pDst)
+	{
+		std::size_t i = 0;
+		for (; i + 32 <= size; i += 32)
+		{
+			const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + i));
+			if (_mm256_movemask_epi8(data) != 0)
+				return i;
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(data)));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(data, 1)));
+		}
+
+		return widenSse2(pSrc, size, pDst, i);
+	}
+
+	TARGET_SSE2 static std::size_t narrowSse2(const char16_t* pSrc, const std::size_t& size, char* pDst, std::size_t i)
+	{
+		const __m128i nonAscii = _mm_set1_epi16(static_cast<short>(0xFF80));
+		const __m128i zero     = _mm_setzero_si128();
+
+		for (; i + 16 <= size; i += 16)
+		{
+			const __m128i low  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+			const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i + 8));
+
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(_mm_or_si128(low, high), nonAscii), zero)) != 0xFFFF)
+				break;
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), _mm_packus_epi16(low, high));
+		}
+
+		return i;
+	}
+
+	TARGET_AVX2 static std::size_t narrowAvx2(const char16_t* pSrc, const std::size_t& size, char* pDst)
+	{
+		const __m256i nonAscii = _mm256_set1_epi16(static_cast<short>(0xFF80));
+
+		std::size_t i = 0;
+		for (; i + 32 <= size; i += 32)
+		{
+			const __m256i low  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + i));
+			const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSrc + i + 16));
+
+			if (!_mm256_testz_si256(_mm256_or_si256(low, high), nonAscii))
+				return i;
+
+			// The pack works within the 128 bit lanes, the permute restores the order
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDst + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(low, high), 0xD8));
+		}
+
+		return narrowSse2(pSrc, size, pDst, i);
+	}
+#endif
+};
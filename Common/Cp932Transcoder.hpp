@@ -0,0 +1,281 @@
+/*
+ *  File: Cp932Transcoder.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AsciiRun.hpp"
+#include "Cp932Table.hpp"
+#include "ScratchBuffer.hpp"
+#include "Utf8.hpp"
+
+//
+// Converts between CP932 (Shift-JIS as Windows uses it) and UTF-8 in a single pass,
+// without going through UTF-16. It follows MultiByteToWideChar and WideCharToMultiByte
+// with code page 932 and does not depend on Windows, so the tools use it as well.
+//
+class Cp932Transcoder
+{
+	// Encoding direction, built from the decoding table on first use. Characters are
+	// looked up in pages of 256, pages without any CP932 character share page 0.
+	class EncodeTable
+	{
+	public:
+		EncodeTable() :
+			m_codes(256, 0)
+		{
+			m_pages.fill(0);
+
+			for (uint32_t b = 0x80; b < 0x100; b++)
+				add(CP932_HIGH_SINGLE_BYTES[b - 0x80], static_cast<uint16_t>(b));
+
+			// Lead bytes in ascending order, if several codes decode to the same character the lowest is used like on Windows.
+			// The exception are the NEC selected IBM extensions in 0xED and 0xEE, Windows encodes them as the IBM
+			// extensions in 0xFA to 0xFC, so they come last.
+			for (uint32_t lead = 0x81; lead < 0x100; lead++)
+			{
+				if (!isNecSelectedLead(lead))
+					addLead(lead);
+			}
+
+			addLead(0xED);
+			addLead(0xEE);
+
+			for (const uint16_t* pBestFit : CP932_BEST_FIT)
+				add(pBestFit[0], pBestFit[1]);
+		}
+
+		// Returns 0 if the character has no CP932 code
+		uint16_t Find(const uint32_t& c) const
+		{
+			return m_codes[(static_cast<std::size_t>(m_pages[c >> 8]) << 8) | (c & 0xFF)];
+		}
+
+	private:
+		static bool isNecSelectedLead(const uint32_t& lead)
+		{
+			return lead == 0xED || lead == 0xEE;
+		}
+
+		void addLead(const uint32_t& lead)
+		{
+			for (uint32_t trail = CP932_TRAIL_FIRST; trail <= CP932_TRAIL_LAST; trail++)
+			{
+				if (trail != 0x7F)
+					add(decodeDoubleByte(static_cast<uint8_t>(lead), static_cast<uint8_t>(trail)), static_cast<uint16_t>((lead << 8) | trail));
+			}
+		}
+
+		void add(const uint16_t& c, const uint16_t& code)
+		{
+			if (c == 0)
+				return;
+
+			if (m_pages[c >> 8] == 0)
+			{
+				m_pages[c >> 8] = static_cast<uint8_t>(m_codes.size() >> 8);
+				m_codes.resize(m_codes.size() + 256, 0);
+			}
+
+			uint16_t& entry = m_codes[(static_cast<std::size_t>(m_pages[c >> 8]) << 8) | (c & 0xFF)];
+			if (entry == 0)
+				entry = code;
+		}
+
+	private:
+		std::array<uint8_t, 256> m_pages;
+		std::vector<uint16_t> m_codes;
+	};
+
+public:
+	// Used by Windows for CP932 bytes without a character
+	static constexpr char16_t DEFAULT_CHAR = 0x30FB;
+
+	// Used for characters without a CP932 code and for invalid UTF-8
+	static constexpr char REPLACEMENT_CHAR = '?';
+
+	// Half width katakana and some single bytes become 3 UTF-8 bytes
+	static constexpr std::size_t MaxUtf8Size(const std::size_t& cp932Size)
+	{
+		return cp932Size * 3;
+	}
+
+	// No character takes more bytes in CP932 than in UTF-8
+	static constexpr std::size_t MaxCp932Size(const std::size_t& utf8Size)
+	{
+		return utf8Size;
+	}
+
+	//
+	// Convert the CP932 bytes to UTF-8. The buffer needs room for MaxUtf8Size() bytes,
+	// returns the number of bytes written, no null terminator is added.
+	//
+	static std::size_t ToUtf8(const char* pSrc, const std::size_t& size, char* pDst)
+	{
+		const uint8_t* pIn = reinterpret_cast<const uint8_t*>(pSrc);
+		char* pOut         = pDst;
+
+		for (std::size_t i = 0; i < size;)
+		{
+			const uint8_t b = pIn[i];
+
+			if (b < 0x80)
+			{
+				const std::size_t count = AsciiRun::Copy(pSrc + i, size - i, pOut);
+				pOut += count;
+				i += count;
+				continue;
+			}
+
+			uint32_t c = DEFAULT_CHAR;
+
+			if (CP932_LEAD_ROWS[b] == CP932_NO_LEAD)
+			{
+				c = CP932_HIGH_SINGLE_BYTES[b - 0x80];
+				i++;
+			}
+			else if (i + 1 < size && isTrailByte(pIn[i + 1]))
+			{
+				c = decodeDoubleByte(b, pIn[i + 1]);
+				if (c == 0)
+					c = DEFAULT_CHAR;
+
+				i += 2;
+			}
+			else
+			{
+				// A lead byte without trail byte, the next byte is converted on its own
+				i++;
+			}
+
+			Utf8::Write(c, pOut);
+		}
+
+		return static_cast<std::size_t>(pOut - pDst);
+	}
+
+	//
+	// Convert the UTF-8 bytes to CP932. The buffer needs room for MaxCp932Size() bytes,
+	// returns the number of bytes written, no null terminator is added.
+	//
+	static std::size_t FromUtf8(const char* pSrc, const std::size_t& size, char* pDst)
+	{
+		const EncodeTable& table = getEncodeTable();
+		const uint8_t* pIn       = reinterpret_cast<const uint8_t*>(pSrc);
+		char* pOut               = pDst;
+
+		for (std::size_t i = 0; i < size;)
+		{
+			if (pIn[i] < 0x80)
+			{
+				const std::size_t count = AsciiRun::Copy(pSrc + i, size - i, pOut);
+				pOut += count;
+				i += count;
+				continue;
+			}
+
+			uint32_t c               = 0;
+			const std::size_t length = Utf8::Read(pIn + i, size - i, c);
+			i += length;
+
+			const uint16_t code = c < 0x10000 ? table.Find(c) : 0;
+
+			if (code == 0)
+				*pOut++ = REPLACEMENT_CHAR;
+			else if (code < 0x100)
+				*pOut++ = static_cast<char>(code);
+			else
+			{
+				*pOut++ = static_cast<char>(code >> 8);
+				*pOut++ = static_cast<char>(code & 0xFF);
+			}
+		}
+
+		return static_cast<std::size_t>(pOut - pDst);
+	}
+
+	// Convert into the buffer, the null terminated result is valid until the buffer is used again
+	static std::string_view ToUtf8(const std::string_view& cp932, ScratchBuffer<char>& buffer)
+	{
+		char* pDst = buffer.Reserve(MaxUtf8Size(cp932.size()));
+		return buffer.Finish(ToUtf8(cp932.data(), cp932.size(), pDst));
+	}
+
+	static std::string_view FromUtf8(const std::string_view& utf8, ScratchBuffer<char>& buffer)
+	{
+		char* pDst = buffer.Reserve(MaxCp932Size(utf8.size()));
+		return buffer.Finish(FromUtf8(utf8.data(), utf8.size(), pDst));
+	}
+
+	static std::string ToUtf8(const std::string_view& cp932)
+	{
+		std::string utf8(MaxUtf8Size(cp932.size()), '\0');
+		utf8.resize(ToUtf8(cp932.data(), cp932.size(), utf8.data()));
+		return utf8;
+	}
+
+	static std::string FromUtf8(const std::string_view& utf8)
+	{
+		std::string cp932(MaxCp932Size(utf8.size()), '\0');
+		cp932.resize(FromUtf8(utf8.data(), utf8.size(), cp932.data()));
+		return cp932;
+	}
+
+private:
+	static const EncodeTable& getEncodeTable()
+	{
+		static const EncodeTable table;
+		return table;
+	}
+
+	static bool isTrailByte(const uint8_t& b)
+	{
+		return b >= CP932_TRAIL_FIRST && b <= CP932_TRAIL_LAST && b != 0x7F;
+	}
+
+	// Returns 0 for codes without a character
+	static uint16_t decodeDoubleByte(const uint8_t& lead, const uint8_t& trail)
+	{
+		const uint8_t row = CP932_LEAD_ROWS[lead];
+		if (row == CP932_NO_LEAD)
+			return 0;
+
+		if (row == CP932_USER_LEAD)
+		{
+			// 188 trail bytes per lead byte, 0x7F is skipped
+			const uint32_t index = (lead - CP932_USER_LEAD_FIRST) * 188 + (trail - CP932_TRAIL_FIRST) - (trail > 0x7F ? 1 : 0);
+			return static_cast<uint16_t>(0xE000 + index);
+		}
+
+		return CP932_DOUBLE_BYTE_TABLE[row * CP932_ROW_SIZE + (trail - CP932_TRAIL_FIRST)];
+	}
+};
@@ -0,0 +1,130 @@
+/*
+ *  File: CpuFeatures.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_FEATURES_X86 1
+#else
+#define CPU_FEATURES_X86 0
+#endif
+
+// SSE2 is part of the baseline of every x64 build and of x86 builds with /arch:SSE2 or -msse2
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define CPU_FEATURES_SSE2_BASELINE 1
+#else
+#define CPU_FEATURES_SSE2_BASELINE 0
+#endif
+
+#if CPU_FEATURES_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// MSVC allows all intrinsics everywhere, GCC and Clang only inside functions built for the instruction set
+#if defined(_MSC_VER) || !CPU_FEATURES_X86
+#define TARGET_SSE2
+#define TARGET_AVX2
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+//
+// Instruction sets of the CPU the process runs on, used to pick the fastest of
+// several implementations at runtime without requiring them at build time
+//
+struct CpuFeatures
+{
+	bool sse2 = false;
+	bool avx2 = false;
+
+	static const CpuFeatures& Get()
+	{
+		static const CpuFeatures features = detect();
+		return features;
+	}
+
+private:
+	static CpuFeatures detect()
+	{
+		CpuFeatures features;
+
+#if CPU_FEATURES_X86
+		uint32_t regs[4] = {};
+
+		cpuid(0, regs);
+		const uint32_t maxLeaf = regs[0];
+
+		cpuid(1, regs);
+		features.sse2 = (regs[3] & (1u << 26)) != 0;
+
+		// AVX registers are only usable if the OS saves them on a context switch
+		const bool osxsave = (regs[2] & (1u << 27)) != 0;
+		const bool avx     = (regs[2] & (1u << 28)) != 0;
+
+		if (maxLeaf >= 7 && osxsave && avx && (xgetbv() & 0x6) == 0x6)
+		{
+			cpuid(7, regs);
+			features.avx2 = (regs[1] & (1u << 5)) != 0;
+		}
+#endif
+
+		return features;
+	}
+
+#if CPU_FEATURES_X86
+	static void cpuid(const uint32_t& leaf, uint32_t regs[4])
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuidex(info, static_cast<int>(leaf), 0);
+
+		for (int i = 0; i < 4; i++)
+			regs[i] = static_cast<uint32_t>(info[i]);
+#else
+		__cpuid_count(leaf, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	}
+
+	static uint64_t xgetbv()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		uint32_t eax, edx;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return eax | (static_cast<uint64_t>(edx) << 32);
+#endif
+	}
+#endif
+};
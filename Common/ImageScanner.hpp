@@ -0,0 +1,312 @@
+/*
+ *  File: ImageScanner.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "AddressCache.hpp"
+#include "PeImage.hpp"
+#include "SignatureScanner.hpp"
+
+//
+// Finds signatures in the sections of a PE image. A pattern can name the section
+// it is in, otherwise all executable sections are searched. Headers, data and
+// resources are never scanned for code.
+//
+class ImageScanner
+{
+	struct Entry
+	{
+		SignaturePattern pattern;
+		std::string section;
+	};
+
+public:
+	static constexpr uint32_t NOT_FOUND = static_cast<uint32_t>(-1);
+
+	//
+	// Large sections are scanned on the given number of threads, 0 uses as many as there
+	// are cores. It has to stay 1 inside DllMain, where worker threads can not start.
+	//
+	explicit ImageScanner(const PeImage& image, const std::size_t& threadCount = 1) :
+		m_image(image),
+		m_threadCount(threadCount)
+	{
+	}
+
+	// Returns the index of the pattern in the scan results, an empty section name stands for all executable sections
+	std::size_t Add(const SignaturePattern& pattern, const std::string& section = "")
+	{
+		m_entries.push_back({ pattern, section });
+		return m_entries.size() - 1;
+	}
+
+	std::size_t Size() const
+	{
+		return m_entries.size();
+	}
+
+	const PeImage& GetImage() const
+	{
+		return m_image;
+	}
+
+	//
+	// Returns the RVA every pattern stands for or NOT_FOUND. That is its first match, the
+	// sections are searched in header order, followed by the steps of the pattern.
+	//
+	std::vector<uint32_t> Scan()
+	{
+		std::vector<uint32_t> rvas = FindMatches();
+		for (std::size_t i = 0; i < rvas.size(); i++)
+			rvas[i] = Resolve(i, rvas[i]);
+
+		return rvas;
+	}
+
+	// Returns the RVA of the first match of every pattern or NOT_FOUND, without following the steps
+	std::vector<uint32_t> FindMatches()
+	{
+		std::vector<uint32_t> rvas(m_entries.size(), NOT_FOUND);
+		m_scannedBytes = 0;
+		m_cachedCount  = 0;
+
+		for (const PeSection& section : m_image.GetSections())
+		{
+			// Every section is scanned once for all patterns that may be in it and were not found yet
+			SignatureScanner scanner;
+			std::vector<std::size_t> indices;
+
+			for (std::size_t i = 0; i < m_entries.size(); i++)
+			{
+				if (rvas[i] == NOT_FOUND && isInSection(m_entries[i], section))
+				{
+					scanner.Add(m_entries[i].pattern);
+					indices.push_back(i);
+				}
+			}
+
+			if (indices.empty())
+				continue;
+
+			const std::size_t size                 = m_image.GetSectionSize(section);
+			const std::vector<std::size_t> offsets = scanner.ScanParallel(m_image.GetSectionData(section), size, m_threadCount);
+			m_scannedBytes += size;
+
+			for (std::size_t k = 0; k < indices.size(); k++)
+			{
+				if (offsets[k] != SignatureScanner::NOT_FOUND)
+					rvas[indices[k]] = m_image.GetRva(section, offsets[k]);
+			}
+		}
+
+		return rvas;
+	}
+
+	//
+	// Like Scan(), but a pattern that still matches at its cached address is not searched
+	// for. If all of them match, the image is not scanned at all. The addresses found by
+	// the scan are added to the cache. The cache holds where the patterns matched, so the
+	// steps are followed again and see the current bytes.
+	//
+	std::vector<uint32_t> Scan(AddressCache& cache)
+	{
+		std::vector<uint32_t> rvas(m_entries.size(), NOT_FOUND);
+		ImageScanner scanner(m_image, m_threadCount);
+		std::vector<std::size_t> indices;
+
+		for (std::size_t i = 0; i < m_entries.size(); i++)
+		{
+			const uint32_t cachedRva = cache.Find(m_entries[i].pattern, m_entries[i].section);
+			if (cachedRva != AddressCache::NOT_FOUND && matchesAt(m_entries[i], cachedRva))
+				rvas[i] = cachedRva;
+			else
+			{
+				scanner.Add(m_entries[i].pattern, m_entries[i].section);
+				indices.push_back(i);
+			}
+		}
+
+		m_cachedCount  = m_entries.size() - indices.size();
+		m_scannedBytes = 0;
+
+		if (!indices.empty())
+		{
+			const std::vector<uint32_t> foundRvas = scanner.FindMatches();
+			m_scannedBytes                        = scanner.GetScannedBytes();
+
+			for (std::size_t k = 0; k < indices.size(); k++)
+			{
+				if (foundRvas[k] == NOT_FOUND)
+					continue;
+
+				const Entry& entry = m_entries[indices[k]];
+				rvas[indices[k]]   = foundRvas[k];
+				cache.Set(entry.pattern, entry.section, foundRvas[k]);
+			}
+		}
+
+		for (std::size_t i = 0; i < rvas.size(); i++)
+			rvas[i] = Resolve(i, rvas[i]);
+
+		return rvas;
+	}
+
+	//
+	// Follows the steps of the pattern at the index from the RVA it matched at. Returns
+	// NOT_FOUND if a step leaves the sections of the image or reads past their data.
+	//
+	uint32_t Resolve(const std::size_t& index, const uint32_t& matchRva) const
+	{
+		if (matchRva == NOT_FOUND)
+			return NOT_FOUND;
+
+		int64_t rva = matchRva;
+
+		for (const SignatureStep& step : m_entries[index].pattern.GetSteps())
+		{
+			if (step.type == SignatureStep::Type::Relative)
+			{
+				const int64_t operandRva = rva + step.offset;
+				if (operandRva < 0 || operandRva >= NOT_FOUND)
+					return NOT_FOUND;
+
+				const uint8_t* pOperand = m_image.GetRvaData(static_cast<uint32_t>(operandRva), sizeof(int32_t));
+				if (pOperand == nullptr)
+					return NOT_FOUND;
+
+				int32_t displacement;
+				std::memcpy(&displacement, pOperand, sizeof(displacement));
+
+				rva += step.instructionSize + static_cast<int64_t>(displacement);
+			}
+			else
+				rva += step.offset;
+
+			if (rva < 0 || rva >= NOT_FOUND || m_image.FindSectionByRva(static_cast<uint32_t>(rva)) == nullptr)
+				return NOT_FOUND;
+		}
+
+		return static_cast<uint32_t>(rva);
+	}
+
+	//
+	// Number of matches of every pattern in the sections it may be in. Much slower than
+	// a scan, meant for checking offline that the signatures are unique.
+	//
+	std::vector<std::size_t> CountMatches() const
+	{
+		std::vector<std::size_t> counts(m_entries.size(), 0);
+
+		for (const PeSection& section : m_image.GetSections())
+		{
+			const uint8_t* pData   = m_image.GetSectionData(section);
+			const std::size_t size = m_image.GetSectionSize(section);
+
+			for (std::size_t i = 0; i < m_entries.size(); i++)
+			{
+				if (isInSection(m_entries[i], section))
+					counts[i] += countMatches(m_entries[i].pattern, pData, size);
+			}
+		}
+
+		return counts;
+	}
+
+	// Number of bytes the last scan searched
+	std::size_t GetScannedBytes() const
+	{
+		return m_scannedBytes;
+	}
+
+	// Number of patterns the last scan took from the address cache
+	std::size_t GetCachedCount() const
+	{
+		return m_cachedCount;
+	}
+
+private:
+	static bool isInSection(const Entry& entry, const PeSection& section)
+	{
+		return entry.section.empty() ? section.IsExecutable() : entry.section == section.name;
+	}
+
+	static std::size_t countMatches(const SignaturePattern& pattern, const uint8_t* pData, const std::size_t& size)
+	{
+		// Like for the scanner, a pattern without fixed bytes never matches
+		std::size_t lead = 0;
+		while (lead < pattern.Size() && !pattern.IsFixed(lead))
+			lead++;
+
+		if (lead == pattern.Size() || pattern.Size() > size)
+			return 0;
+
+		std::size_t count   = 0;
+		const uint8_t* pEnd = pData + size - pattern.Size() + 1;
+
+		for (const uint8_t* pPos = pData; pPos < pEnd; pPos++)
+		{
+			// Only positions with the first fixed byte in place are compared
+			pPos = static_cast<const uint8_t*>(std::memchr(pPos + lead, pattern.GetBytes()[lead], pEnd - pPos));
+			if (pPos == nullptr)
+				break;
+
+			pPos -= lead;
+			if (pattern.Matches(pPos))
+				count++;
+		}
+
+		return count;
+	}
+
+	// Checks the pattern against the bytes at the RVA, which has to be in a section the pattern may be in
+	bool matchesAt(const Entry& entry, const uint32_t& rva) const
+	{
+		for (const PeSection& section : m_image.GetSections())
+		{
+			if (rva < section.virtualAddress || !isInSection(entry, section))
+				continue;
+
+			const std::size_t offset = rva - section.virtualAddress;
+			if (offset < m_image.GetSectionSize(section) && entry.pattern.Size() <= m_image.GetSectionSize(section) - offset)
+				return entry.pattern.Matches(m_image.GetSectionData(section) + offset);
+		}
+
+		return false;
+	}
+
+private:
+	PeImage m_image;
+	std::size_t m_threadCount;
+	std::vector<Entry> m_entries;
+	std::size_t m_scannedBytes = 0;
+	std::size_t m_cachedCount  = 0;
+};
@@ -0,0 +1,142 @@
+/*
+ *  File: MappedFile.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//
+// Read-only memory mapping of a whole file.
+// The view stays valid until the object is closed or destroyed.
+//
+class MappedFile
+{
+public:
+	MappedFile() = default;
+
+	~MappedFile()
+	{
+		Close();
+	}
+
+	MappedFile(const MappedFile&)            = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const std::filesystem::path& path)
+	{
+		Close();
+
+#ifdef _WIN32
+		// Other processes may rename or delete the file while it is mapped
+		HANDLE hFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (hFile == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0)
+		{
+			CloseHandle(hFile);
+			return false;
+		}
+
+		HANDLE hMapping = CreateFileMappingW(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(hFile);
+
+		if (hMapping == nullptr)
+			return false;
+
+		// The view keeps the mapping alive, so neither handle is needed afterwards
+		m_pData = static_cast<const char*>(MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0));
+		CloseHandle(hMapping);
+
+		if (m_pData == nullptr)
+			return false;
+
+		m_size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+		const int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0)
+		{
+			close(fd);
+			return false;
+		}
+
+		void* pView = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+
+		if (pView == MAP_FAILED)
+			return false;
+
+		m_pData = static_cast<const char*>(pView);
+		m_size  = static_cast<std::size_t>(st.st_size);
+#endif
+
+		return true;
+	}
+
+	void Close()
+	{
+		if (m_pData == nullptr)
+			return;
+
+#ifdef _WIN32
+		UnmapViewOfFile(m_pData);
+#else
+		munmap(const_cast<char*>(m_pData), m_size);
+#endif
+
+		m_pData = nullptr;
+		m_size  = 0;
+	}
+
+	const char* GetData() const
+	{
+		return m_pData;
+	}
+
+	std::size_t GetSize() const
+	{
+		return m_size;
+	}
+
+private:
+	const char* m_pData = nullptr;
+	std::size_t m_size  = 0;
+};
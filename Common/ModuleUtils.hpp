@@ -0,0 +1,116 @@
+/*
+ *  File: ModuleUtils.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include "AddressCache.hpp"
+#include "ImageScanner.hpp"
+#include "PeImage.hpp"
+
+//
+// Helpers around the modules of the game process shared by the redirect DLLs.
+// Each DLL compiles its own copy, so "this DLL" always refers to the one using them.
+//
+
+//
+// Determine the addresses of the functions in the scanned image, every section is
+// scanned once for all patterns that may be in it. Addresses found on an earlier
+// start of the same executable are only checked, the scan is skipped if they all
+// still match. Functions that are not found get the address ~0.
+//
+inline std::vector<uintptr_t> findFunctions(ImageScanner& scanner, const std::filesystem::path& executablePath, const std::filesystem::path& cachePath)
+{
+	std::vector<uintptr_t> funcAddrs(scanner.Size(), static_cast<uintptr_t>(-1));
+	if (scanner.Size() == 0)
+		return funcAddrs;
+
+	const uintptr_t baseAddress = reinterpret_cast<uintptr_t>(scanner.GetImage().GetData());
+
+	std::vector<uint32_t> rvas;
+	ImageFingerprint fingerprint;
+
+	if (AddressCache::ReadFingerprint(executablePath, fingerprint))
+	{
+		AddressCache cache;
+		cache.Load(cachePath, fingerprint);
+		rvas = scanner.Scan(cache);
+
+		if (cache.IsModified())
+			cache.Save(cachePath);
+	}
+	else
+		rvas = scanner.Scan();
+
+	for (std::size_t i = 0; i < rvas.size(); i++)
+	{
+		if (rvas[i] != ImageScanner::NOT_FOUND)
+			funcAddrs[i] = baseAddress + rvas[i];
+	}
+
+	return funcAddrs;
+}
+
+#ifdef _WIN32
+
+// Headers of the executable as it is loaded in memory
+inline PeImage getModuleImage()
+{
+	return PeImage::FromModule(reinterpret_cast<const uint8_t*>(GetModuleHandleW(nullptr)));
+}
+
+// Full path of a loaded module, nullptr for the executable
+inline std::filesystem::path getModulePath(HMODULE hModule)
+{
+	WCHAR wzPath[MAX_PATH];
+	const DWORD length = GetModuleFileNameW(hModule, wzPath, ARRAYSIZE(wzPath));
+	return std::filesystem::path(std::wstring(wzPath, length));
+}
+
+// The resolved addresses are stored next to this DLL
+inline std::filesystem::path getAddressCachePath()
+{
+	HMODULE hModule = nullptr;
+	GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT, reinterpret_cast<LPCWSTR>(&getAddressCachePath), &hModule);
+
+	std::filesystem::path cachePath = getModulePath(hModule);
+	cachePath.replace_extension(".cache");
+	return cachePath;
+}
+
+// Addresses of the functions in the executable, cached next to this DLL
+inline std::vector<uintptr_t> findFunctions(ImageScanner& scanner)
+{
+	return findFunctions(scanner, getModulePath(nullptr), getAddressCachePath());
+}
+#endif
@@ -0,0 +1,166 @@
+/*
+ *  File: PatternResultCache.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+
+//
+// Insert-only cache of pattern results shared by all threads without locks.
+//
+// The table is a fixed number of slots holding atomic pointers to immutable
+// entries. Lookups only load pointers, inserts claim an empty slot with a single
+// compare and swap. Entries are never removed or changed, so a returned result
+// stays valid until the cache is destroyed. Once the probed slots are taken new
+// results are not cached anymore and have to be computed again.
+//
+// Keys no pattern matches are cached as well, for them NO_MATCH is returned so a
+// repeated miss costs one lookup too.
+//
+class PatternResultCache
+{
+	static constexpr std::size_t DEFAULT_CAPACITY = 64 * 1024;
+	static constexpr std::size_t MAX_PROBES       = 32;
+
+	struct Entry
+	{
+		std::size_t hash;
+		std::u16string key;
+		std::u16string result;
+		bool matched;
+	};
+
+public:
+	// Result returned for keys inserted with InsertNoMatch, only compared by address
+	static inline const std::u16string NO_MATCH;
+
+	// The capacity is rounded up to a power of two
+	explicit PatternResultCache(const std::size_t& capacity = DEFAULT_CAPACITY)
+	{
+		std::size_t slotCount = 1;
+		while (slotCount < capacity)
+			slotCount <<= 1;
+
+		m_pSlots = std::make_unique<std::atomic<const Entry*>[]>(slotCount);
+		m_mask   = slotCount - 1;
+
+		for (std::size_t i = 0; i < slotCount; i++)
+			m_pSlots[i].store(nullptr, std::memory_order_relaxed);
+	}
+
+	~PatternResultCache()
+	{
+		for (std::size_t i = 0; i <= m_mask; i++)
+			delete m_pSlots[i].load(std::memory_order_relaxed);
+	}
+
+	PatternResultCache(const PatternResultCache&)            = delete;
+	PatternResultCache& operator=(const PatternResultCache&) = delete;
+
+	// Returns the cached null terminated result, &NO_MATCH or nullptr if the key is not cached, wait-free
+	const std::u16string* Find(const std::u16string_view& key) const
+	{
+		const std::size_t hash = std::hash<std::u16string_view>{}(key);
+
+		for (std::size_t i = 0; i < MAX_PROBES; i++)
+		{
+			const Entry* pEntry = m_pSlots[(hash + i) & m_mask].load(std::memory_order_acquire);
+			if (pEntry == nullptr)
+				return nullptr;
+
+			if (pEntry->hash == hash && pEntry->key == key)
+				return resultOf(pEntry);
+		}
+
+		return nullptr;
+	}
+
+	//
+	// Cache the result of the key and return the stored copy. If another thread
+	// inserted the key first its result is returned instead, if no probed slot is
+	// free nullptr is returned.
+	//
+	const std::u16string* Insert(const std::u16string_view& key, const std::u16string_view& result)
+	{
+		return insert(key, result, true);
+	}
+
+	// Cache that no pattern matches the key, returns &NO_MATCH or the result like Insert
+	const std::u16string* InsertNoMatch(const std::u16string_view& key)
+	{
+		return insert(key, {}, false);
+	}
+
+	std::size_t Size() const
+	{
+		return m_size.load(std::memory_order_relaxed);
+	}
+
+private:
+	static const std::u16string* resultOf(const Entry* pEntry)
+	{
+		return pEntry->matched ? &pEntry->result : &NO_MATCH;
+	}
+
+	const std::u16string* insert(const std::u16string_view& key, const std::u16string_view& result, const bool& matched)
+	{
+		const std::size_t hash = std::hash<std::u16string_view>{}(key);
+		std::unique_ptr<Entry> pNew;
+
+		for (std::size_t i = 0; i < MAX_PROBES; i++)
+		{
+			std::atomic<const Entry*>& slot = m_pSlots[(hash + i) & m_mask];
+			const Entry* pEntry             = slot.load(std::memory_order_acquire);
+
+			if (pEntry == nullptr)
+			{
+				if (!pNew)
+					pNew = std::make_unique<Entry>(Entry{ hash, std::u16string(key), std::u16string(result), matched });
+
+				// On failure the entry that took the slot is loaded and compared below
+				if (slot.compare_exchange_strong(pEntry, pNew.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+				{
+					m_size.fetch_add(1, std::memory_order_relaxed);
+					return resultOf(pNew.release());
+				}
+			}
+
+			if (pEntry->hash == hash && pEntry->key == key)
+				return resultOf(pEntry);
+		}
+
+		return nullptr;
+	}
+
+	std::unique_ptr<std::atomic<const Entry*>[]> m_pSlots;
+	std::size_t m_mask = 0;
+	std::atomic<std::size_t> m_size = 0;
+};
@@ -0,0 +1,303 @@
+/*
+ *  File: PeImage.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//
+// Minimal reader for the headers of PE images, written against plain bytes so it
+// works for the running module as well as for executables read from disk.
+// Only the parts needed to locate sections and identify a build are parsed.
+//
+enum class PeLayout
+{
+	File,  // Read from disk, the sections are at their file offsets
+	Mapped // Loaded by Windows, the sections are at their virtual addresses
+};
+
+struct PeSection
+{
+	static constexpr uint32_t CNT_CODE    = 0x00000020;
+	static constexpr uint32_t MEM_EXECUTE = 0x20000000;
+	static constexpr uint32_t MEM_WRITE   = 0x80000000;
+
+	std::string name;
+	uint32_t virtualAddress  = 0;
+	uint32_t virtualSize     = 0;
+	uint32_t rawOffset       = 0;
+	uint32_t rawSize         = 0;
+	uint32_t characteristics = 0;
+
+	bool IsExecutable() const
+	{
+		return (characteristics & (CNT_CODE | MEM_EXECUTE)) != 0;
+	}
+
+	bool IsWritable() const
+	{
+		return (characteristics & MEM_WRITE) != 0;
+	}
+};
+
+class PeImage
+{
+	static constexpr uint16_t DOS_SIGNATURE  = 0x5A4D;     // MZ
+	static constexpr uint32_t NT_SIGNATURE   = 0x00004550; // PE\0\0
+	static constexpr uint16_t PE32_MAGIC     = 0x10B;
+	static constexpr uint16_t PE32PLUS_MAGIC = 0x20B;
+
+	static constexpr std::size_t FILE_HEADER_SIZE    = 20;
+	static constexpr std::size_t SECTION_HEADER_SIZE = 40;
+	static constexpr std::size_t SECTION_NAME_SIZE   = 8;
+
+public:
+	// Throws std::runtime_error if the data is no valid PE image
+	PeImage(const uint8_t* pData, const std::size_t& size, const PeLayout& layout) :
+		m_pData(pData),
+		m_size(size),
+		m_layout(layout)
+	{
+		parse();
+	}
+
+	//
+	// The image of a loaded module, e.g. the one of GetModuleHandle(nullptr).
+	// Its size is only known from the headers, which are trusted to be mapped.
+	//
+	static PeImage FromModule(const uint8_t* pBase)
+	{
+		PeImage image(pBase, std::numeric_limits<std::size_t>::max(), PeLayout::Mapped);
+		image.m_size = image.m_sizeOfImage;
+		return image;
+	}
+
+	const uint8_t* GetData() const
+	{
+		return m_pData;
+	}
+
+	std::size_t GetSize() const
+	{
+		return m_size;
+	}
+
+	bool Is64Bit() const
+	{
+		return m_is64Bit;
+	}
+
+	uint16_t GetMachine() const
+	{
+		return m_machine;
+	}
+
+	uint32_t GetTimeDateStamp() const
+	{
+		return m_timeDateStamp;
+	}
+
+	uint32_t GetSizeOfImage() const
+	{
+		return m_sizeOfImage;
+	}
+
+	uint32_t GetCheckSum() const
+	{
+		return m_checkSum;
+	}
+
+	uint64_t GetImageBase() const
+	{
+		return m_imageBase;
+	}
+
+	const std::vector<PeSection>& GetSections() const
+	{
+		return m_sections;
+	}
+
+	// Returns nullptr if there is no section with the name
+	const PeSection* FindSection(const std::string_view& name) const
+	{
+		for (const PeSection& section : m_sections)
+		{
+			if (section.name == name)
+				return &section;
+		}
+
+		return nullptr;
+	}
+
+	// Offset of the section in the data, depending on the layout
+	std::size_t GetSectionOffset(const PeSection& section) const
+	{
+		return m_layout == PeLayout::Mapped ? section.virtualAddress : section.rawOffset;
+	}
+
+	// Bytes of the section present in the data, clamped to the data
+	std::size_t GetSectionSize(const PeSection& section) const
+	{
+		std::size_t size = section.rawSize;
+
+		// In memory the section spans its virtual size, some linkers leave that 0
+		if (m_layout == PeLayout::Mapped && section.virtualSize != 0)
+			size = section.virtualSize;
+
+		const std::size_t offset = GetSectionOffset(section);
+		if (offset >= m_size)
+			return 0;
+
+		return std::min(size, m_size - offset);
+	}
+
+	const uint8_t* GetSectionData(const PeSection& section) const
+	{
+		return m_pData + GetSectionOffset(section);
+	}
+
+	// RVA of a position inside the section data
+	uint32_t GetRva(const PeSection& section, const std::size_t& sectionOffset) const
+	{
+		return section.virtualAddress + static_cast<uint32_t>(sectionOffset);
+	}
+
+	// Returns nullptr if the RVA is in no section
+	const PeSection* FindSectionByRva(const uint32_t& rva) const
+	{
+		for (const PeSection& section : m_sections)
+		{
+			const uint32_t size = std::max(section.virtualSize, section.rawSize);
+			if (rva >= section.virtualAddress && rva - section.virtualAddress < size)
+				return &section;
+		}
+
+		return nullptr;
+	}
+
+	// Returns nullptr if the data does not contain the given number of bytes at the RVA
+	const uint8_t* GetRvaData(const uint32_t& rva, const std::size_t& count) const
+	{
+		const PeSection* pSection = FindSectionByRva(rva);
+		if (pSection == nullptr)
+			return nullptr;
+
+		const std::size_t offset = rva - pSection->virtualAddress;
+		const std::size_t size   = GetSectionSize(*pSection);
+		if (offset >= size || count > size - offset)
+			return nullptr;
+
+		return GetSectionData(*pSection) + offset;
+	}
+
+private:
+	void parse()
+	{
+		if (read<uint16_t>(0) != DOS_SIGNATURE)
+			throw std::runtime_error("Invalid DOS header signature");
+
+		const std::size_t ntOffset = read<uint32_t>(0x3C);
+		if (read<uint32_t>(ntOffset) != NT_SIGNATURE)
+			throw std::runtime_error("Invalid NT header signature");
+
+		const std::size_t fileHeader = ntOffset + 4;
+		m_machine                    = read<uint16_t>(fileHeader);
+		const uint16_t sectionCount  = read<uint16_t>(fileHeader + 2);
+		m_timeDateStamp              = read<uint32_t>(fileHeader + 4);
+		const uint16_t optionalSize  = read<uint16_t>(fileHeader + 16);
+
+		const std::size_t optionalHeader = fileHeader + FILE_HEADER_SIZE;
+		const uint16_t magic             = read<uint16_t>(optionalHeader);
+
+		if (magic != PE32_MAGIC && magic != PE32PLUS_MAGIC)
+			throw std::runtime_error("Invalid optional header magic");
+
+		m_is64Bit     = magic == PE32PLUS_MAGIC;
+		m_imageBase   = m_is64Bit ? read<uint64_t>(optionalHeader + 24) : read<uint32_t>(optionalHeader + 28);
+		m_sizeOfImage = read<uint32_t>(optionalHeader + 56);
+		m_checkSum    = read<uint32_t>(optionalHeader + 64);
+
+		// The section table directly follows the optional header, whatever its size
+		const std::size_t sectionTable = optionalHeader + optionalSize;
+
+		for (uint16_t i = 0; i < sectionCount; i++)
+		{
+			const std::size_t header = sectionTable + i * SECTION_HEADER_SIZE;
+
+			char name[SECTION_NAME_SIZE];
+			readBytes(header, name, SECTION_NAME_SIZE);
+
+			PeSection section;
+			section.name            = std::string(name, strnlen(name, SECTION_NAME_SIZE));
+			section.virtualSize     = read<uint32_t>(header + 8);
+			section.virtualAddress  = read<uint32_t>(header + 12);
+			section.rawSize         = read<uint32_t>(header + 16);
+			section.rawOffset       = read<uint32_t>(header + 20);
+			section.characteristics = read<uint32_t>(header + 36);
+
+			m_sections.push_back(section);
+		}
+	}
+
+	// The headers are little endian and not necessarily aligned
+	template<typename T>
+	T read(const std::size_t& offset) const
+	{
+		T value;
+		readBytes(offset, &value, sizeof(T));
+		return value;
+	}
+
+	void readBytes(const std::size_t& offset, void* pDst, const std::size_t& count) const
+	{
+		if (offset > m_size || count > m_size - offset)
+			throw std::runtime_error("PE headers exceed the image");
+
+		std::memcpy(pDst, m_pData + offset, count);
+	}
+
+private:
+	const uint8_t* m_pData;
+	std::size_t m_size;
+	PeLayout m_layout;
+
+	bool m_is64Bit           = false;
+	uint16_t m_machine       = 0;
+	uint32_t m_timeDateStamp = 0;
+	uint32_t m_sizeOfImage   = 0;
+	uint32_t m_checkSum      = 0;
+	uint64_t m_imageBase     = 0;
+
+	std::vector<PeSection> m_sections;
+};
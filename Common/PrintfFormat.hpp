@@ -0,0 +1,248 @@
+/*
+ *  File: PrintfFormat.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+//
+// Checks for printf style formats in translations
+//
+// Translated format templates are used in place of the original format with the
+// arguments the game passes for the original, so a translation has to read exactly
+// the same arguments. It may reorder them with positions like "%2$s %1$d", which the
+// _p functions of the MSVC runtime support.
+//
+
+//
+// Arguments read by the format in argument order, each reduced to the type it is read
+// as: 'i' int, 'l' long, 'q' 64 bit integer, 'z' pointer sized integer, 'd' double,
+// 'D' long double, 's' narrow string, 'S' wide string and 'p' pointer. A star width or
+// precision reads an int. Returns false if the string is no valid format, e.g. a lone
+// '%' at its end, "%n", or positions that are skipped, repeated or mixed with ordinary
+// conversions.
+//
+inline bool getPrintfArguments(const std::string_view& format, std::string& arguments)
+{
+	static constexpr std::size_t MAX_POSITION = 99;
+
+	enum class Length
+	{
+		None,
+		Short,
+		Long,
+		LongLong,
+		Size,
+		LongDouble,
+		Wide
+	};
+
+	const auto isDigit = [](const char& c) { return c >= '0' && c <= '9'; };
+
+	std::string positional; // Argument types by position, 0 for positions not used yet
+	bool usesPositions = false;
+	bool usesSequence  = false;
+
+	arguments.clear();
+
+	for (std::size_t i = 0; i < format.size(); i++)
+	{
+		if (format[i] != '%')
+			continue;
+
+		if (++i == format.size())
+			return false;
+
+		if (format[i] == '%')
+			continue;
+
+		// Position of the argument, e.g. the 2 of "%2$s"
+		std::size_t position = 0;
+		std::size_t end      = i;
+		while (end < format.size() && isDigit(format[end]) && position <= MAX_POSITION)
+			position = position * 10 + static_cast<std::size_t>(format[end++] - '0');
+
+		if (end > i && end < format.size() && format[end] == '$')
+		{
+			if (position == 0 || position > MAX_POSITION)
+				return false;
+
+			i = end + 1;
+		}
+		else
+			position = 0;
+
+		while (i < format.size() && std::string_view("-+ #0").find(format[i]) != std::string_view::npos)
+			i++;
+
+		// Width and precision
+		std::string stars;
+		for (int part = 0; part < 2; part++)
+		{
+			if (part == 1)
+			{
+				if (i >= format.size() || format[i] != '.')
+					break;
+
+				i++;
+			}
+
+			if (i < format.size() && format[i] == '*')
+			{
+				stars.push_back('i');
+				i++;
+			}
+			else
+			{
+				while (i < format.size() && isDigit(format[i]))
+					i++;
+			}
+		}
+
+		const std::string_view rest = format.substr(i);
+		Length length               = Length::None;
+
+		static constexpr std::pair<std::string_view, Length> LENGTHS[] = {
+			{ "hh", Length::Short }, { "h", Length::Short }, { "ll", Length::LongLong }, { "l", Length::Long }, { "L", Length::LongDouble },
+			{ "I64", Length::LongLong }, { "I32", Length::None }, { "I", Length::Size }, { "j", Length::LongLong }, { "z", Length::Size },
+			{ "t", Length::Size }, { "w", Length::Wide }
+		};
+
+		for (const auto& [modifier, modifierLength] : LENGTHS)
+		{
+			if (rest.substr(0, modifier.size()) == modifier)
+			{
+				length = modifierLength;
+				i += modifier.size();
+				break;
+			}
+		}
+
+		if (i >= format.size())
+			return false;
+
+		char type = 0;
+
+		switch (format[i])
+		{
+			case 'd':
+			case 'i':
+			case 'o':
+			case 'u':
+			case 'x':
+			case 'X':
+				if (length == Length::LongDouble || length == Length::Wide)
+					return false;
+
+				type = length == Length::LongLong ? 'q' : length == Length::Size ? 'z' : length == Length::Long ? 'l' : 'i';
+				break;
+			case 'c':
+			case 'C':
+				// Characters are promoted to int
+				type = 'i';
+				break;
+			case 'e':
+			case 'E':
+			case 'f':
+			case 'F':
+			case 'g':
+			case 'G':
+			case 'a':
+			case 'A':
+				if (length != Length::None && length != Length::Long && length != Length::LongDouble)
+					return false;
+
+				type = length == Length::LongDouble ? 'D' : 'd';
+				break;
+			case 's':
+				type = length == Length::Long || length == Length::Wide ? 'S' : 's';
+				break;
+			case 'S':
+				type = length == Length::Short ? 's' : 'S';
+				break;
+			case 'p':
+				type = 'p';
+				break;
+			default:
+				// Including %n, which writes to its argument
+				return false;
+		}
+
+		if (position == 0)
+		{
+			if (usesPositions)
+				return false;
+
+			usesSequence = true;
+			arguments += stars;
+			arguments.push_back(type);
+			continue;
+		}
+
+		// A star takes the next argument, which has no meaning together with positions
+		if (usesSequence || !stars.empty())
+			return false;
+
+		usesPositions = true;
+
+		if (positional.size() < position)
+			positional.resize(position, '\0');
+
+		if (positional[position - 1] != '\0')
+			return false;
+
+		positional[position - 1] = type;
+	}
+
+	if (usesPositions)
+	{
+		if (positional.find('\0') != std::string::npos)
+			return false;
+
+		arguments = std::move(positional);
+	}
+
+	return true;
+}
+
+//
+// Whether a translation may be used as the format in place of the original, i.e. it
+// reads the same arguments, possibly reordered. An original without a '%' is never
+// used as a format and one that is no valid format can not be formatted at all, so
+// their translations are not restricted.
+//
+inline bool isTranslatedFormatValid(const std::string_view& original, const std::string_view& translation)
+{
+	std::string originalArguments;
+	if (original.find('%') == std::string_view::npos || !getPrintfArguments(original, originalArguments))
+		return true;
+
+	std::string translatedArguments;
+	return getPrintfArguments(translation, translatedArguments) && translatedArguments == originalArguments;
+}
@@ -0,0 +1,80 @@
+/*
+ *  File: ScratchBuffer.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+//
+// Growable buffer for short lived strings, e.g. the formatted text of a hook. It is
+// reused instead of allocating a new string on every call and only allocates when a
+// string is longer than all before. A view into the buffer is valid until the next
+// string is written to it.
+//
+template<typename CharT>
+class ScratchBuffer
+{
+	static constexpr std::size_t INITIAL_SIZE = 4096;
+
+public:
+	ScratchBuffer() = default;
+
+	ScratchBuffer(const ScratchBuffer&)            = delete;
+	ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+
+	// Returns room for the given number of characters and a null terminator, the previous content is lost
+	CharT* Reserve(const std::size_t& size)
+	{
+		if (size + 1 > m_data.size())
+		{
+			// Nothing has to be kept, so the old content is not copied
+			const std::size_t newSize = std::max({ size + 1, m_data.size() * 2, INITIAL_SIZE });
+			m_data.clear();
+			m_data.resize(newSize);
+		}
+
+		return m_data.data();
+	}
+
+	// Terminate the string of the given length written to the reserved room and return it
+	std::basic_string_view<CharT> Finish(const std::size_t& length)
+	{
+		m_data[length] = CharT();
+		return { m_data.data(), length };
+	}
+
+	// Characters that fit without allocating, not counting the null terminator
+	std::size_t Capacity() const
+	{
+		return m_data.empty() ? 0 : m_data.size() - 1;
+	}
+
+private:
+	std::vector<CharT> m_data;
+};
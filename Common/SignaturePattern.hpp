@@ -0,0 +1,239 @@
+/*
+ *  File: SignaturePattern.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "CpuFeatures.hpp"
+
+//
+// Step from the position of a match to the address a pattern stands for
+//
+struct SignatureStep
+{
+	enum class Type
+	{
+		Skip,    // Move by the offset
+		Relative // Move to the target of the rel32 at the offset, relative to the end of the instruction
+	};
+
+	Type type;
+	int32_t offset;
+	int32_t instructionSize; // Counted from the current position like the offset, only used by Relative
+};
+
+//
+// Byte pattern with wildcards, stored as value/mask pairs. A data byte matches
+// if it equals the value in all bits set in the mask, so wildcards have a mask
+// of 0 and a value of 0.
+//
+class SignaturePattern
+{
+public:
+	SignaturePattern() = default;
+
+	// A pattern without wildcards
+	SignaturePattern(std::vector<uint8_t> bytes) :
+		m_bytes(std::move(bytes)),
+		m_mask(m_bytes.size(), 0xFF)
+	{
+	}
+
+	//
+	// Parse an IDA style pattern like "48 8B 05 ?? ?? ?? ??". Bytes are separated by
+	// spaces, "?" or "??" matches any byte and a single "?" digit like "4?" any nibble.
+	//
+	static SignaturePattern Parse(const std::string_view& str)
+	{
+		SignaturePattern pattern;
+
+		std::size_t pos = 0;
+		while (pos < str.size())
+		{
+			if (str[pos] == ' ')
+			{
+				pos++;
+				continue;
+			}
+
+			std::size_t end = str.find(' ', pos);
+			if (end == std::string_view::npos)
+				end = str.size();
+
+			const std::string_view token = str.substr(pos, end - pos);
+			pos                          = end;
+
+			if (token == "?" || token == "??")
+			{
+				pattern.m_bytes.push_back(0);
+				pattern.m_mask.push_back(0);
+				continue;
+			}
+
+			if (token.size() != 2)
+				throw std::runtime_error("Invalid signature byte \"" + std::string(token) + "\" in: " + std::string(str));
+
+			uint8_t value = 0;
+			uint8_t mask  = 0;
+
+			for (const char& c : token)
+			{
+				const int32_t digit = parseHexDigit(c);
+				if (digit < 0 && c != '?')
+					throw std::runtime_error("Invalid signature byte \"" + std::string(token) + "\" in: " + std::string(str));
+
+				value = static_cast<uint8_t>((value << 4) | (digit < 0 ? 0 : digit));
+				mask  = static_cast<uint8_t>((mask << 4) | (digit < 0 ? 0 : 0xF));
+			}
+
+			pattern.m_bytes.push_back(value);
+			pattern.m_mask.push_back(mask);
+		}
+
+		return pattern;
+	}
+
+	//
+	// A pattern does not have to match where the function starts. Short patterns around a
+	// call site often survive game updates better than a prologue, the steps lead from the
+	// match to the called function or the referenced data. They are applied in order, every
+	// step starts where the previous one ended.
+	//
+
+	// Continue at the target of the call or jmp with the rel32 at the offset, e.g. 1 for "E8 ?? ?? ?? ??"
+	SignaturePattern FollowRelative(const int32_t& offset) const
+	{
+		return withStep({ SignatureStep::Type::Relative, offset, offset + 4 });
+	}
+
+	// Continue at the address of the RIP-relative operand at the offset, e.g. 3 and 7 for "48 8D 0D ?? ?? ?? ??".
+	// The instruction size is needed since an immediate may follow the operand.
+	SignaturePattern ResolveRipRelative(const int32_t& offset, const int32_t& instructionSize) const
+	{
+		return withStep({ SignatureStep::Type::Relative, offset, instructionSize });
+	}
+
+	// Continue the given number of bytes further, e.g. back to the start of the function the pattern is in
+	SignaturePattern Skip(const int32_t& offset) const
+	{
+		return withStep({ SignatureStep::Type::Skip, offset, 0 });
+	}
+
+	const std::vector<SignatureStep>& GetSteps() const
+	{
+		return m_steps;
+	}
+
+	std::size_t Size() const
+	{
+		return m_bytes.size();
+	}
+
+	bool Empty() const
+	{
+		return m_bytes.empty();
+	}
+
+	// Wildcard bits are 0
+	const std::vector<uint8_t>& GetBytes() const
+	{
+		return m_bytes;
+	}
+
+	const std::vector<uint8_t>& GetMask() const
+	{
+		return m_mask;
+	}
+
+	// True if the byte at the index is no wildcard, not even partially
+	bool IsFixed(const std::size_t& index) const
+	{
+		return m_mask[index] == 0xFF;
+	}
+
+	bool Matches(const std::size_t& index, const uint8_t& value) const
+	{
+		return (value & m_mask[index]) == m_bytes[index];
+	}
+
+	// The data has to contain at least Size() bytes
+	bool Matches(const uint8_t* pData) const
+	{
+		std::size_t i = 0;
+
+#if CPU_FEATURES_SSE2_BASELINE
+		for (; i + 16 <= m_bytes.size(); i += 16)
+		{
+			const __m128i data  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i));
+			const __m128i mask  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_mask.data() + i));
+			const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_bytes.data() + i));
+
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(data, mask), bytes)) != 0xFFFF)
+				return false;
+		}
+#endif
+
+		for (; i < m_bytes.size(); i++)
+		{
+			if ((pData[i] & m_mask[i]) != m_bytes[i])
+				return false;
+		}
+
+		return true;
+	}
+
+private:
+	SignaturePattern withStep(const SignatureStep& step) const
+	{
+		SignaturePattern pattern = *this;
+		pattern.m_steps.push_back(step);
+		return pattern;
+	}
+
+	static int32_t parseHexDigit(const char& c)
+	{
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		if (c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F')
+			return c - 'A' + 10;
+
+		return -1;
+	}
+
+private:
+	std::vector<uint8_t> m_bytes;
+	std::vector<uint8_t> m_mask;
+	std::vector<SignatureStep> m_steps;
+};
@@ -0,0 +1,492 @@
+/*
+ *  File: SignatureScanner.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "CpuFeatures.hpp"
+#include "SignaturePattern.hpp"
+
+enum class ScanKernel
+{
+	Scalar,
+	SSE2,
+	AVX2
+};
+
+//
+// Finds several byte patterns, e.g. the function signatures of all hooks, in a
+// single pass over a block of memory.
+//
+// The vector kernels anchor every pattern on its two rarest fixed bytes, judged by
+// a byte histogram sampled from the scanned data. Both anchor bytes are compared
+// for 16 or 32 positions at once and only the positions where both match are
+// verified with a masked compare. The scalar kernel buckets the patterns by their
+// first fixed byte and checks every position against a bitmap of that byte and
+// the values its successor may have.
+//
+// Found patterns are dropped, so the scan ends once every pattern was found.
+// Large blocks can be split into chunks that are scanned on several threads.
+//
+class SignatureScanner
+{
+	// Two bytes of a pattern that are compared for a whole block of positions
+	struct Anchor
+	{
+		uint32_t pattern;
+		uint32_t offset1;
+		uint32_t offset2;
+		uint8_t byte1;
+		uint8_t byte2;
+	};
+
+public:
+	static constexpr std::size_t NOT_FOUND = static_cast<std::size_t>(-1);
+
+	// Returns the index of the pattern in the scan results, a pattern without fixed bytes is never found
+	std::size_t Add(const SignaturePattern& pattern)
+	{
+		const std::size_t index = m_patterns.size();
+		m_patterns.push_back(pattern);
+
+		std::size_t lead = 0;
+		while (lead < pattern.Size() && !pattern.IsFixed(lead))
+			lead++;
+
+		m_leads.push_back(static_cast<uint32_t>(lead));
+
+		if (lead == pattern.Size())
+			return index;
+
+		const uint8_t leadByte = pattern.GetBytes()[lead];
+
+		// The lead byte may be followed by every value its successor matches, or anything at the end
+		for (uint32_t next = 0; next < 256; next++)
+		{
+			if (lead + 1 == pattern.Size() || pattern.Matches(lead + 1, static_cast<uint8_t>(next)))
+				setPair(leadByte, static_cast<uint8_t>(next));
+		}
+
+		return index;
+	}
+
+	std::size_t Size() const
+	{
+		return m_patterns.size();
+	}
+
+	const SignaturePattern& GetPattern(const std::size_t& index) const
+	{
+		return m_patterns[index];
+	}
+
+	// The fastest kernel the CPU supports
+	static ScanKernel GetBestKernel()
+	{
+		const CpuFeatures& features = CpuFeatures::Get();
+
+		if (features.avx2)
+			return ScanKernel::AVX2;
+
+		if (features.sse2)
+			return ScanKernel::SSE2;
+
+		return ScanKernel::Scalar;
+	}
+
+	// Returns the offset of the first match of every pattern or NOT_FOUND
+	std::vector<std::size_t> Scan(const uint8_t* pData, const std::size_t& size) const
+	{
+		return Scan(pData, size, GetBestKernel());
+	}
+
+	// Scan with the given kernel, which has to be supported by the CPU
+	std::vector<std::size_t> Scan(const uint8_t* pData, const std::size_t& size, const ScanKernel& kernel) const
+	{
+		std::vector<std::size_t> offsets(m_patterns.size(), NOT_FOUND);
+		scanRange(pData, size, kernel, selectAnchors(pData, size), offsets);
+		return offsets;
+	}
+
+	//
+	// Scan on several threads with the fastest kernel, the result is the same as the one of
+	// Scan(). The data is split into overlapping chunks that are handed out in order, and a
+	// chunk is only searched for the patterns not found before it. So the workers stop once
+	// every pattern was found and the lowest offset always wins.
+	//
+	// A thread count of 0 uses as many threads as there are cores, up to a limit. Threads
+	// must not be used inside DllMain, they can not start while the loader lock is held.
+	//
+	std::vector<std::size_t> ScanParallel(const uint8_t* pData, const std::size_t& size, std::size_t threadCount = 0) const
+	{
+		static constexpr std::size_t CHUNK_SIZE  = 4 * 1024 * 1024;
+		static constexpr std::size_t MAX_THREADS = 8;
+
+		if (threadCount == 0)
+			threadCount = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), MAX_THREADS);
+
+		const std::size_t chunkCount = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+		threadCount                  = std::min(threadCount, chunkCount);
+
+		if (threadCount <= 1)
+			return Scan(pData, size);
+
+		const ScanKernel kernel           = GetBestKernel();
+		const std::vector<Anchor> anchors = selectAnchors(pData, size);
+
+		// A match may start in the last bytes of a chunk, so every chunk also covers the start of the next one
+		std::size_t overlap = 0;
+		for (const Anchor& anchor : anchors)
+			overlap = std::max(overlap, m_patterns[anchor.pattern].Size() - 1);
+
+		// Lowest offset found so far of every pattern
+		std::vector<std::atomic<std::size_t>> offsets(m_patterns.size());
+		for (std::atomic<std::size_t>& offset : offsets)
+			offset.store(NOT_FOUND, std::memory_order_relaxed);
+
+		std::atomic<std::size_t> nextChunk = 0;
+
+		const auto worker = [&]() {
+			std::vector<Anchor> chunkAnchors;
+			std::vector<std::size_t> chunkOffsets(m_patterns.size());
+
+			for (std::size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+			{
+				const std::size_t begin = chunk * CHUNK_SIZE;
+				const std::size_t end   = std::min(size, begin + CHUNK_SIZE + overlap);
+
+				// A pattern found before the chunk can not get a lower offset from it
+				chunkAnchors.clear();
+				for (const Anchor& anchor : anchors)
+				{
+					if (offsets[anchor.pattern].load(std::memory_order_relaxed) >= begin)
+						chunkAnchors.push_back(anchor);
+				}
+
+				// The chunks are handed out in order, so all later ones would skip every pattern too
+				if (chunkAnchors.empty())
+					break;
+
+				std::fill(chunkOffsets.begin(), chunkOffsets.end(), NOT_FOUND);
+				scanRange(pData + begin, end - begin, kernel, chunkAnchors, chunkOffsets);
+
+				for (const Anchor& anchor : chunkAnchors)
+				{
+					if (chunkOffsets[anchor.pattern] == NOT_FOUND)
+						continue;
+
+					const std::size_t found = begin + chunkOffsets[anchor.pattern];
+					std::size_t current     = offsets[anchor.pattern].load(std::memory_order_relaxed);
+
+					while (found < current && !offsets[anchor.pattern].compare_exchange_weak(current, found, std::memory_order_relaxed))
+					{
+					}
+				}
+			}
+		};
+
+		// The calling thread scans as well
+		std::vector<std::thread> threads;
+		for (std::size_t i = 1; i < threadCount; i++)
+			threads.emplace_back(worker);
+
+		worker();
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		std::vector<std::size_t> result(m_patterns.size());
+		for (std::size_t i = 0; i < m_patterns.size(); i++)
+			result[i] = offsets[i].load(std::memory_order_relaxed);
+
+		return result;
+	}
+
+private:
+	// Search the patterns of the anchors, the offsets of the found ones are set
+	void scanRange(const uint8_t* pData, const std::size_t& size, const ScanKernel& kernel, std::vector<Anchor> anchors, std::vector<std::size_t>& offsets) const
+	{
+#if CPU_FEATURES_X86
+		if (kernel == ScanKernel::AVX2 || kernel == ScanKernel::SSE2)
+		{
+			const std::size_t done = (kernel == ScanKernel::AVX2) ? scanAvx2(pData, size, anchors, offsets) : scanSse2(pData, size, anchors, offsets);
+
+			scanTail(pData, size, done, anchors, offsets);
+			return;
+		}
+#endif
+
+		scanScalar(pData, size, anchors, offsets);
+	}
+
+	void scanScalar(const uint8_t* pData, const std::size_t& size, const std::vector<Anchor>& anchors, std::vector<std::size_t>& offsets) const
+	{
+		// The patterns are bucketed by their first fixed byte, the anchors only tell which ones to search
+		std::array<std::vector<uint32_t>, 256> buckets;
+		for (const Anchor& anchor : anchors)
+			buckets[m_patterns[anchor.pattern].GetBytes()[m_leads[anchor.pattern]]].push_back(anchor.pattern);
+
+		std::size_t remaining = anchors.size();
+
+		for (std::size_t i = 0; i < size && remaining > 0; i++)
+		{
+			// The last byte has no successor, only its bucket can tell
+			if (i + 1 < size && !hasPair(pData[i], pData[i + 1]))
+				continue;
+
+			std::vector<uint32_t>& bucket = buckets[pData[i]];
+			if (bucket.empty())
+				continue;
+
+			for (std::size_t k = 0; k < bucket.size();)
+			{
+				const SignaturePattern& pattern = m_patterns[bucket[k]];
+				const std::size_t lead          = m_leads[bucket[k]];
+
+				// The lead byte sits at position i, so the pattern starts lead bytes earlier
+				if (i < lead || i - lead + pattern.Size() > size || !pattern.Matches(pData + i - lead))
+				{
+					k++;
+					continue;
+				}
+
+				offsets[bucket[k]] = i - lead;
+				bucket[k]          = bucket.back();
+				bucket.pop_back();
+				remaining--;
+			}
+		}
+	}
+
+#if CPU_FEATURES_X86
+	// Returns the position up to which the data was scanned
+	TARGET_SSE2 std::size_t scanSse2(const uint8_t* pData, const std::size_t& size, std::vector<Anchor>& anchors, std::vector<std::size_t>& offsets) const
+	{
+		const std::size_t end = getVectorEnd(size, anchors, 16);
+
+		std::size_t i = 0;
+		for (; i < end && !anchors.empty(); i += 16)
+		{
+			for (std::size_t k = 0; k < anchors.size();)
+			{
+				const Anchor& anchor = anchors[k];
+
+				const __m128i first  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i + anchor.offset1));
+				const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i + anchor.offset2));
+				const __m128i match  = _mm_and_si128(_mm_cmpeq_epi8(first, _mm_set1_epi8(static_cast<char>(anchor.byte1))), _mm_cmpeq_epi8(second, _mm_set1_epi8(static_cast<char>(anchor.byte2))));
+
+				if (!verifyCandidates(pData, size, i, static_cast<uint32_t>(_mm_movemask_epi8(match)), anchors, k, offsets))
+					k++;
+			}
+		}
+
+		return i;
+	}
+
+	TARGET_AVX2 std::size_t scanAvx2(const uint8_t* pData, const std::size_t& size, std::vector<Anchor>& anchors, std::vector<std::size_t>& offsets) const
+	{
+		const std::size_t end = getVectorEnd(size, anchors, 32);
+
+		std::size_t i = 0;
+		for (; i < end && !anchors.empty(); i += 32)
+		{
+			for (std::size_t k = 0; k < anchors.size();)
+			{
+				const Anchor& anchor = anchors[k];
+
+				const __m256i first  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pData + i + anchor.offset1));
+				const __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pData + i + anchor.offset2));
+				const __m256i match  = _mm256_and_si256(_mm256_cmpeq_epi8(first, _mm256_set1_epi8(static_cast<char>(anchor.byte1))), _mm256_cmpeq_epi8(second, _mm256_set1_epi8(static_cast<char>(anchor.byte2))));
+
+				if (!verifyCandidates(pData, size, i, static_cast<uint32_t>(_mm256_movemask_epi8(match)), anchors, k, offsets))
+					k++;
+			}
+		}
+
+		return i;
+	}
+#endif
+
+	//
+	// Check the candidate positions of a block, bit n of the mask stands for position i + n.
+	// Returns true if the pattern was found, which removes its anchor.
+	//
+	bool verifyCandidates(const uint8_t* pData, const std::size_t& size, const std::size_t& i, uint32_t mask, std::vector<Anchor>& anchors, const std::size_t& k, std::vector<std::size_t>& offsets) const
+	{
+		const SignaturePattern& pattern = m_patterns[anchors[k].pattern];
+
+		while (mask != 0)
+		{
+			const std::size_t pos = i + countTrailingZeros(mask);
+			mask &= mask - 1;
+
+			if (pos + pattern.Size() <= size && pattern.Matches(pData + pos))
+			{
+				offsets[anchors[k].pattern] = pos;
+				anchors[k]                  = anchors.back();
+				anchors.pop_back();
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Search the positions the vector kernels could not load a full block for
+	void scanTail(const uint8_t* pData, const std::size_t& size, const std::size_t& start, const std::vector<Anchor>& anchors, std::vector<std::size_t>& offsets) const
+	{
+		for (const Anchor& anchor : anchors)
+		{
+			const SignaturePattern& pattern = m_patterns[anchor.pattern];
+
+			for (std::size_t pos = start; pos + pattern.Size() <= size; pos++)
+			{
+				if (pattern.Matches(pData + pos))
+				{
+					offsets[anchor.pattern] = pos;
+					break;
+				}
+			}
+		}
+	}
+
+	// Blocks are only loaded while the anchors of every remaining pattern stay inside the data
+	static std::size_t getVectorEnd(const std::size_t& size, const std::vector<Anchor>& anchors, const std::size_t& blockSize)
+	{
+		std::size_t maxOffset = 0;
+		for (const Anchor& anchor : anchors)
+			maxOffset = std::max<std::size_t>(maxOffset, std::max(anchor.offset1, anchor.offset2));
+
+		return size >= maxOffset + blockSize ? size - maxOffset - blockSize + 1 : 0;
+	}
+
+	std::vector<Anchor> selectAnchors(const uint8_t* pData, const std::size_t& size) const
+	{
+		const std::array<uint32_t, 256> frequencies = sampleByteFrequencies(pData, size);
+
+		std::vector<Anchor> anchors;
+
+		for (std::size_t i = 0; i < m_patterns.size(); i++)
+		{
+			const SignaturePattern& pattern   = m_patterns[i];
+			const std::vector<uint8_t>& bytes = pattern.GetBytes();
+
+			if (m_leads[i] == pattern.Size() || pattern.Size() > size)
+				continue;
+
+			Anchor anchor  = {};
+			anchor.pattern = static_cast<uint32_t>(i);
+			anchor.offset1 = m_leads[i];
+
+			// Only fixed bytes can be compared for equality
+			for (uint32_t j = anchor.offset1 + 1; j < pattern.Size(); j++)
+			{
+				if (pattern.IsFixed(j) && frequencies[bytes[j]] < frequencies[bytes[anchor.offset1]])
+					anchor.offset1 = j;
+			}
+
+			// A pattern with a single fixed byte uses it twice
+			anchor.offset2 = anchor.offset1;
+			for (uint32_t j = 0; j < pattern.Size(); j++)
+			{
+				if (j != anchor.offset1 && pattern.IsFixed(j) && (anchor.offset2 == anchor.offset1 || frequencies[bytes[j]] < frequencies[bytes[anchor.offset2]]))
+					anchor.offset2 = j;
+			}
+
+			anchor.byte1 = bytes[anchor.offset1];
+			anchor.byte2 = bytes[anchor.offset2];
+			anchors.push_back(anchor);
+		}
+
+		return anchors;
+	}
+
+	// Histogram of the data, large blocks are sampled at evenly spread chunks
+	static std::array<uint32_t, 256> sampleByteFrequencies(const uint8_t* pData, const std::size_t& size)
+	{
+		static constexpr std::size_t SAMPLE_COUNT = 256;
+		static constexpr std::size_t SAMPLE_SIZE  = 4096;
+
+		std::array<uint32_t, 256> frequencies = {};
+
+		if (size <= SAMPLE_COUNT * SAMPLE_SIZE)
+		{
+			for (std::size_t i = 0; i < size; i++)
+				frequencies[pData[i]]++;
+
+			return frequencies;
+		}
+
+		const std::size_t stride = (size - SAMPLE_SIZE) / (SAMPLE_COUNT - 1);
+		for (std::size_t sample = 0; sample < SAMPLE_COUNT; sample++)
+		{
+			const uint8_t* pSample = pData + sample * stride;
+			for (std::size_t i = 0; i < SAMPLE_SIZE; i++)
+				frequencies[pSample[i]]++;
+		}
+
+		return frequencies;
+	}
+
+	static uint32_t countTrailingZeros(const uint32_t& value)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, value);
+		return index;
+#else
+		return static_cast<uint32_t>(__builtin_ctz(value));
+#endif
+	}
+
+	void setPair(const uint8_t& first, const uint8_t& second)
+	{
+		const uint32_t pair = first | (static_cast<uint32_t>(second) << 8);
+		m_pairs[pair >> 6] |= 1ull << (pair & 63);
+	}
+
+	bool hasPair(const uint8_t& first, const uint8_t& second) const
+	{
+		const uint32_t pair = first | (static_cast<uint32_t>(second) << 8);
+		return (m_pairs[pair >> 6] >> (pair & 63)) & 1;
+	}
+
+private:
+	std::vector<SignaturePattern> m_patterns;
+
+	// Offset of the first fixed byte of every pattern, which decides its bucket
+	std::vector<uint32_t> m_leads;
+
+	// One bit for every lead byte and value that may follow it
+	std::array<uint64_t, 65536 / 64> m_pairs = {};
+};
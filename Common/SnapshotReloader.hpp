@@ -0,0 +1,356 @@
+/*
+ *  File: SnapshotReloader.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//
+// Hot reload of immutable snapshots, e.g. the loaded translations
+//
+// The current snapshot is published through an atomic pointer, so readers like the
+// hooks never lock or wait. A watcher thread polls the modification times of the
+// watched files and directories and rebuilds the snapshot off the render thread
+// whenever they changed and settled for one poll interval.
+//
+// The first snapshot can be loaded on the watcher thread as well, so DllMain only
+// starts the thread and returns. Until it is published Read returns an empty guard
+// and the hooks pass the game strings through untouched.
+//
+// Readers hold a ReadGuard while they use a snapshot. A guard registers itself in
+// one of two reader counters, picked by the parity of the current phase. The phase
+// only advances once the readers of the other parity left, so after two advances
+// every reader that could have seen a replaced snapshot is gone and it is freed.
+//
+template<typename Snapshot>
+class SnapshotReloader
+{
+	// Snapshots retired in phase p are unreachable once the phase reached p + 2
+	static constexpr uint64_t GRACE_PHASES = 2;
+
+	struct Retired
+	{
+		std::unique_ptr<Snapshot> pSnapshot;
+		uint64_t phase;
+	};
+
+	// Each counter in a cache line of its own, readers of both phases do not share one
+	struct alignas(64) ReaderCount
+	{
+		std::atomic<uint32_t> count = 0;
+	};
+
+public:
+	using Loader = std::function<std::unique_ptr<Snapshot>()>;
+
+	//
+	// Keeps the snapshot that was current when the guard was taken alive. Guards are
+	// cheap and meant to be held for the duration of a single hook call.
+	//
+	class ReadGuard
+	{
+	public:
+		ReadGuard(const ReadGuard&)            = delete;
+		ReadGuard& operator=(const ReadGuard&) = delete;
+
+		~ReadGuard()
+		{
+			m_pReaders->count.fetch_sub(1, std::memory_order_release);
+		}
+
+		const Snapshot* Get() const
+		{
+			return m_pSnapshot;
+		}
+
+		const Snapshot* operator->() const
+		{
+			return m_pSnapshot;
+		}
+
+		explicit operator bool() const
+		{
+			return m_pSnapshot != nullptr;
+		}
+
+	private:
+		friend class SnapshotReloader;
+
+		ReadGuard(const SnapshotReloader& reloader) :
+			m_pReaders(&reloader.m_readers[reloader.m_phase.load(std::memory_order_seq_cst) & 1])
+		{
+			// Registered before the snapshot is loaded, so the watcher either sees this reader
+			// when it checks the counter or this reader sees the snapshot replacing the old one
+			m_pReaders->count.fetch_add(1, std::memory_order_seq_cst);
+			m_pSnapshot = reloader.m_pCurrent.load(std::memory_order_seq_cst);
+		}
+
+	private:
+		ReaderCount* m_pReaders;
+		const Snapshot* m_pSnapshot = nullptr;
+	};
+
+	SnapshotReloader() = default;
+
+	~SnapshotReloader()
+	{
+		Stop();
+		delete m_pCurrent.load(std::memory_order_acquire);
+	}
+
+	SnapshotReloader(const SnapshotReloader&)            = delete;
+	SnapshotReloader& operator=(const SnapshotReloader&) = delete;
+
+	// Lock-free, the snapshot stays valid until the guard is destroyed
+	ReadGuard Read() const
+	{
+		return ReadGuard(*this);
+	}
+
+	// Replace the current snapshot, a null snapshot is ignored
+	void Publish(std::unique_ptr<Snapshot> pSnapshot)
+	{
+		if (!pSnapshot)
+			return;
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		Snapshot* pOld = m_pCurrent.exchange(pSnapshot.release(), std::memory_order_seq_cst);
+		if (pOld != nullptr)
+			m_retired.push_back({ std::unique_ptr<Snapshot>(pOld), m_phase.load(std::memory_order_relaxed) });
+	}
+
+	//
+	// Start watching the given paths, the loader is called on the watcher thread and
+	// may return nullptr or throw to keep the current snapshot. The initial loader,
+	// if any, is run on the watcher thread before the watching starts.
+	//
+	void Start(std::vector<std::filesystem::path> paths, Loader loader, Loader initialLoader = Loader(), const std::chrono::milliseconds& interval = std::chrono::milliseconds(500))
+	{
+		Stop();
+
+		m_stop   = false;
+		m_thread = std::thread([this, paths = std::move(paths), loader = std::move(loader), initialLoader = std::move(initialLoader), interval]() {
+			watch(paths, loader, initialLoader, interval);
+		});
+	}
+
+	// Stop the watcher thread and wait for it to finish
+	void Stop()
+	{
+		requestStop();
+
+		if (m_thread.joinable())
+			m_thread.join();
+	}
+
+	//
+	// Stop the watcher thread without waiting for it. Used from DllMain, where
+	// waiting for a thread deadlocks on the loader lock. The DLLs pin themselves when
+	// they start watching, so the thread never runs after their code was unloaded.
+	//
+	void Detach()
+	{
+		requestStop();
+
+		if (m_thread.joinable())
+			m_thread.detach();
+	}
+
+	//
+	// Free the current and all retired snapshots at once. Only safe once nothing can
+	// read them anymore, e.g. after the hooks were detached. Snapshots still in use by
+	// a reader are left alone.
+	//
+	void Release()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		if (m_readers[0].count.load(std::memory_order_seq_cst) != 0 || m_readers[1].count.load(std::memory_order_seq_cst) != 0)
+			return;
+
+		delete m_pCurrent.exchange(nullptr, std::memory_order_seq_cst);
+		m_retired.clear();
+	}
+
+	uint64_t GetPhase() const
+	{
+		return m_phase.load(std::memory_order_acquire);
+	}
+
+	//
+	// Advance the phase if the readers of the previous one left and free the snapshots
+	// no reader can hold anymore. Never waits, called on every poll and after reloads.
+	//
+	void Reclaim()
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		const uint64_t phase = m_phase.load(std::memory_order_relaxed);
+		if (m_readers[(phase + 1) & 1].count.load(std::memory_order_seq_cst) == 0)
+			m_phase.store(phase + 1, std::memory_order_seq_cst);
+
+		const uint64_t current = m_phase.load(std::memory_order_relaxed);
+
+		std::size_t kept = 0;
+		for (Retired& retired : m_retired)
+		{
+			if (current - retired.phase < GRACE_PHASES)
+				m_retired[kept++] = std::move(retired);
+		}
+
+		m_retired.resize(kept);
+	}
+
+	std::size_t GetRetiredCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		return m_retired.size();
+	}
+
+	//
+	// Combined modification time and size of the paths, the files directly inside a
+	// directory are included. Missing paths contribute nothing.
+	//
+	static uint64_t GetStamp(const std::vector<std::filesystem::path>& paths)
+	{
+		uint64_t stamp = 0;
+
+		const auto addFile = [&stamp](const std::filesystem::path& path) {
+			std::error_code ec;
+			const auto writeTime = std::filesystem::last_write_time(path, ec);
+			if (ec)
+				return;
+
+			const uint64_t size = std::filesystem::is_regular_file(path, ec) ? static_cast<uint64_t>(std::filesystem::file_size(path, ec)) : 0;
+
+			// The entries are summed up, so the iteration order of a directory does not matter
+			uint64_t value = std::hash<std::string>{}(path.string());
+			value ^= static_cast<uint64_t>(writeTime.time_since_epoch().count()) * 0x9E3779B97F4A7C15ull;
+			value ^= size * 0xC2B2AE3D27D4EB4Full;
+			stamp += value;
+		};
+
+		for (const std::filesystem::path& path : paths)
+		{
+			std::error_code ec;
+			addFile(path);
+
+			if (!std::filesystem::is_directory(path, ec))
+				continue;
+
+			for (const auto& entry : std::filesystem::directory_iterator(path, ec))
+				addFile(entry.path());
+		}
+
+		return stamp;
+	}
+
+private:
+	void requestStop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_stopMutex);
+			m_stop = true;
+		}
+
+		m_stopCondition.notify_all();
+	}
+
+	void watch(const std::vector<std::filesystem::path>& paths, const Loader& loader, const Loader& initialLoader, const std::chrono::milliseconds& interval)
+	{
+		// Taken before the initial load, so changes made while loading trigger a reload
+		uint64_t loadedStamp  = GetStamp(paths);
+		uint64_t pendingStamp = loadedStamp;
+
+		if (initialLoader)
+		{
+			try
+			{
+				Publish(initialLoader());
+			}
+			catch (const std::exception&)
+			{
+			}
+		}
+
+		std::unique_lock<std::mutex> lock(m_stopMutex);
+		while (!m_stopCondition.wait_for(lock, interval, [this]() { return m_stop; }))
+		{
+			lock.unlock();
+
+			Reclaim();
+
+			// Only reload once the files stopped changing, editors often write in several steps
+			const uint64_t stamp = GetStamp(paths);
+			if (stamp != loadedStamp && stamp == pendingStamp)
+			{
+				try
+				{
+					Publish(loader());
+				}
+				catch (const std::exception&)
+				{
+				}
+
+				// Usually frees the replaced snapshot right away, the hooks only hold it for a call
+				Reclaim();
+				Reclaim();
+
+				loadedStamp = stamp;
+			}
+
+			pendingStamp = stamp;
+
+			lock.lock();
+		}
+	}
+
+private:
+	std::atomic<Snapshot*> m_pCurrent = nullptr;
+
+	mutable ReaderCount m_readers[2];
+	std::atomic<uint64_t> m_phase = 0;
+
+	mutable std::mutex m_mutex;
+	std::vector<Retired> m_retired;
+
+	std::mutex m_stopMutex;
+	std::condition_variable m_stopCondition;
+	bool m_stop = false;
+	std::thread m_thread;
+};
@@ -0,0 +1,147 @@
+/*
+ *  File: StringArena.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+//
+// Bump pointer arena for strings that live as long as the arena.
+// Strings are copied back to back into large chunks, which keeps them close
+// together in memory and frees all of them with a single Release. Chunks never
+// move, so the returned views stay valid until the arena is released.
+//
+template<typename CharT>
+class BasicStringArena
+{
+	// Characters per chunk, larger strings get a chunk of their own
+	static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+public:
+	using View = std::basic_string_view<CharT>;
+
+	BasicStringArena() = default;
+
+	BasicStringArena(const BasicStringArena&)            = delete;
+	BasicStringArena& operator=(const BasicStringArena&) = delete;
+
+	BasicStringArena(BasicStringArena&&)            = default;
+	BasicStringArena& operator=(BasicStringArena&&) = default;
+
+	// Copy the string into the arena, identical strings are only stored once
+	View Intern(const View& str)
+	{
+		const auto it = m_strings.find(str);
+		if (it != m_strings.end())
+			return *it;
+
+		const View stored = Store(str);
+		m_strings.insert(stored);
+		return stored;
+	}
+
+	// Copy the string into the arena without looking for an identical one, e.g. for unique keys
+	View Store(const View& str)
+	{
+		// Every string is null terminated, so it can be handed out as a C string
+		const std::size_t size = str.size() + 1;
+		CharT* pDst            = allocate(size);
+
+		std::copy(str.begin(), str.end(), pDst);
+		pDst[str.size()] = CharT(0);
+
+		m_used += size;
+		return View(pDst, str.size());
+	}
+
+	// Characters stored including the terminators
+	std::size_t GetUsed() const
+	{
+		return m_used;
+	}
+
+	// Characters allocated for all chunks
+	std::size_t GetCapacity() const
+	{
+		return m_capacity;
+	}
+
+	// Free all strings at once, every view handed out becomes invalid
+	void Release()
+	{
+		m_strings = std::unordered_set<View>();
+		m_chunks  = std::vector<std::unique_ptr<CharT[]>>();
+
+		m_pNext    = nullptr;
+		m_left     = 0;
+		m_used     = 0;
+		m_capacity = 0;
+	}
+
+private:
+	CharT* allocate(const std::size_t& size)
+	{
+		if (size <= m_left)
+		{
+			CharT* pDst = m_pNext;
+			m_pNext += size;
+			m_left -= size;
+			return pDst;
+		}
+
+		// Large strings do not replace the current chunk, so its remaining space is not wasted
+		if (size > CHUNK_SIZE / 4)
+		{
+			m_chunks.push_back(std::make_unique<CharT[]>(size));
+			m_capacity += size;
+			return m_chunks.back().get();
+		}
+
+		m_chunks.push_back(std::make_unique<CharT[]>(CHUNK_SIZE));
+		m_capacity += CHUNK_SIZE;
+
+		m_pNext = m_chunks.back().get() + size;
+		m_left  = CHUNK_SIZE - size;
+		return m_chunks.back().get();
+	}
+
+private:
+	std::vector<std::unique_ptr<CharT[]>> m_chunks;
+	std::unordered_set<View> m_strings;
+
+	CharT* m_pNext         = nullptr;
+	std::size_t m_left     = 0;
+	std::size_t m_used     = 0;
+	std::size_t m_capacity = 0;
+};
+
+using StringArena    = BasicStringArena<char>;
+using U16StringArena = BasicStringArena<char16_t>;
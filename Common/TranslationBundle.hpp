@@ -0,0 +1,941 @@
+/*
+ *  File: TranslationBundle.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "StringArena.hpp"
+
+//
+// Binary translation bundle
+//
+// The bundle is produced offline by the TranslationPacker or in memory from the
+// JSON files and is used in place, i.e. loading it is a single memory mapping.
+//
+// Layout, all offsets are relative to the start of the bundle and all values are
+// stored little endian:
+//   BundleHeader
+//   uint64_t[]      Bloom filter over the key prefixes, rejects most misses in O(1)
+//   uint32_t[]      per bucket seeds of the minimal perfect hash
+//   uint32_t[]      per record key fingerprints, used to reject misses
+//   BundleRecord[]  ordered by their perfect hash slot
+//   uint32_t[]      line offsets and pixel lengths
+//   char16_t[]      null terminated UTF-16 texts
+//   char[]          raw key bytes, CP932 or UTF-16 depending on the key encoding
+//   char[]          null terminated CP932 texts, each followed by its null terminated lines
+//   uint32_t[]      pattern and data entry count of every pattern file
+//   char16_t[]      null terminated pattern and data strings of the pattern files
+//
+
+inline constexpr uint32_t BUNDLE_MAGIC   = 0x4E425254; // "TRBN"
+inline constexpr uint32_t BUNDLE_VERSION = 6;
+
+enum class BundleKeyEncoding : uint32_t
+{
+	CP932 = 0,
+	UTF16 = 1
+};
+
+struct BundleSection
+{
+	uint32_t offset = 0;
+	uint32_t count  = 0;
+};
+
+struct BundleHeader
+{
+	uint32_t magic       = BUNDLE_MAGIC;
+	uint32_t version     = BUNDLE_VERSION;
+	uint32_t keyEncoding = 0;
+	uint32_t fileSize    = 0;
+	BundleSection filter;
+	BundleSection buckets;
+	BundleSection fingerprints;
+	BundleSection records;
+	BundleSection u32Pool;
+	BundleSection widePool;
+	BundleSection keyPool;
+	BundleSection sjisPool;
+	BundleSection templateGroups;
+	BundleSection templateStrings;
+};
+
+struct BundleRecord
+{
+	uint32_t keyOffset;
+	uint32_t keyLength;
+	uint32_t textOffset;
+	uint32_t textLength;
+	uint32_t lineOffset; // Index into the u32 pool, the line offsets are relative to the text
+	uint32_t lineCount;
+	uint32_t pixelOffset; // Index into the u32 pool
+	uint32_t pixelCount;
+	uint32_t wideOffset;
+	uint32_t wideLength;
+	uint32_t flags;
+};
+
+// The translation reads the same printf arguments as its key and may be used as the format in its place
+inline constexpr uint32_t BUNDLE_RECORD_FORMAT = 0x1;
+
+static_assert(sizeof(BundleHeader) == 96, "Unexpected bundle header size");
+static_assert(sizeof(BundleRecord) == 44, "Unexpected bundle record size");
+
+inline constexpr uint64_t BUNDLE_FNV_OFFSET = 0xCBF29CE484222325ull;
+inline constexpr uint64_t BUNDLE_FNV_PRIME  = 0x100000001B3ull;
+
+// Average number of keys per bucket of the perfect hash
+inline constexpr uint32_t BUNDLE_BUCKET_SIZE = 4;
+
+// Number of leading key bytes covered by the filter and filter bits per key
+inline constexpr std::size_t BUNDLE_FILTER_PREFIX = 8;
+inline constexpr uint32_t BUNDLE_FILTER_BITS      = 16;
+
+inline uint64_t hashBundleKey(const char* pData, const std::size_t& length)
+{
+	uint64_t hash = BUNDLE_FNV_OFFSET;
+	for (std::size_t i = 0; i < length; i++)
+	{
+		hash ^= static_cast<uint8_t>(pData[i]);
+		hash *= BUNDLE_FNV_PRIME;
+	}
+
+	return hash;
+}
+
+//
+// Minimal perfect hash in the style of CHD / hash and displace:
+// every key is assigned to a bucket and each bucket stores the seed that maps all
+// of its keys to distinct, otherwise unused slots. A lookup therefore costs one
+// seed read, one fingerprint read and one key compare, independent of the size.
+//
+inline uint64_t mixBundleHash(uint64_t x)
+{
+	x ^= x >> 30;
+	x *= 0xBF58476D1CE4E5B9ull;
+	x ^= x >> 27;
+	x *= 0x94D049BB133111EBull;
+	x ^= x >> 31;
+	return x;
+}
+
+// Map a 32 bit value onto [0, range) without a division
+inline uint32_t reduceBundleHash(const uint32_t& value, const uint32_t& range)
+{
+	return static_cast<uint32_t>((static_cast<uint64_t>(value) * range) >> 32);
+}
+
+inline uint32_t getBundleBucket(const uint64_t& hash, const uint32_t& bucketCount)
+{
+	return reduceBundleHash(static_cast<uint32_t>(mixBundleHash(hash) >> 32), bucketCount);
+}
+
+inline uint32_t getBundleSlot(const uint64_t& hash, const uint32_t& seed, const uint32_t& slotCount)
+{
+	return reduceBundleHash(static_cast<uint32_t>(mixBundleHash(hash + (seed + 1ull) * 0x9E3779B97F4A7C15ull)), slotCount);
+}
+
+inline uint32_t getBundleFingerprint(const uint64_t& hash)
+{
+	return static_cast<uint32_t>(hash);
+}
+
+//
+// Negative lookup filter
+//
+// Most strings passing through the hooks have no translation. Instead of hashing the
+// whole string, only its first BUNDLE_FILTER_PREFIX bytes (zero padded) are checked
+// against a register blocked Bloom filter, i.e. a single 64 bit word holding four bits
+// per key. Numbers, counters and ASCII names are usually rejected by this alone.
+//
+inline uint64_t getBundleKeyPrefix(const char* pData, const std::size_t& length)
+{
+	uint64_t prefix         = 0;
+	const std::size_t count = std::min(length, BUNDLE_FILTER_PREFIX);
+	for (std::size_t i = 0; i < count; i++)
+		prefix |= static_cast<uint64_t>(static_cast<uint8_t>(pData[i])) << (i * 8);
+
+	return prefix;
+}
+
+// Same as above for a null terminated key, reads at most BUNDLE_FILTER_PREFIX bytes
+template<typename CharT>
+uint64_t getBundleKeyPrefix(const CharT* pKey)
+{
+	uint64_t prefix = 0;
+	for (std::size_t i = 0; i < BUNDLE_FILTER_PREFIX / sizeof(CharT) && pKey[i]; i++)
+		prefix |= static_cast<uint64_t>(static_cast<std::make_unsigned_t<CharT>>(pKey[i])) << (i * sizeof(CharT) * 8);
+
+	return prefix;
+}
+
+inline uint32_t getBundleFilterWord(const uint64_t& prefixHash, const uint32_t& wordCount)
+{
+	return reduceBundleHash(static_cast<uint32_t>(prefixHash >> 32), wordCount);
+}
+
+inline uint64_t getBundleFilterMask(const uint64_t& prefixHash)
+{
+	return (1ull << (prefixHash & 63)) | (1ull << ((prefixHash >> 6) & 63)) | (1ull << ((prefixHash >> 12) & 63)) | (1ull << ((prefixHash >> 18) & 63));
+}
+
+//
+// Lookup counters of a bundle, a false positive is a key that passed the filter
+// but has no translation. The counters are only kept in builds with debug logging,
+// otherwise all of them are 0.
+//
+struct BundleLookupStats
+{
+	uint64_t lookups        = 0;
+	uint64_t hits           = 0;
+	uint64_t filterSkips    = 0;
+	uint64_t falsePositives = 0;
+
+	double GetFalsePositiveRate() const
+	{
+		const uint64_t misses = filterSkips + falsePositives;
+		return misses ? static_cast<double>(falsePositives) / static_cast<double>(misses) : 0.0;
+	}
+};
+
+//
+// View of a single translation inside a bundle, only valid as long as the bundle is
+//
+class TranslationRecord
+{
+	friend class TranslationBundle;
+
+public:
+	TranslationRecord() = default;
+
+	explicit operator bool() const
+	{
+		return m_pText != nullptr;
+	}
+
+	const char* GetText() const
+	{
+		return m_pText;
+	}
+
+	std::size_t GetTextLength() const
+	{
+		return m_pRecord->textLength;
+	}
+
+	std::size_t GetLineCount() const
+	{
+		return m_pRecord->lineCount;
+	}
+
+	// Every line is null terminated
+	const char* GetLine(const std::size_t& index) const
+	{
+		return m_pText + m_pU32Pool[m_pRecord->lineOffset + index];
+	}
+
+	std::size_t GetPixelLengthCount() const
+	{
+		return m_pRecord->pixelCount;
+	}
+
+	uint32_t GetPixelLength(const std::size_t& index) const
+	{
+		return index < m_pRecord->pixelCount ? m_pU32Pool[m_pRecord->pixelOffset + index] : 0;
+	}
+
+	const char16_t* GetWideText() const
+	{
+		return m_pWideText;
+	}
+
+	std::size_t GetWideTextLength() const
+	{
+		return m_pRecord->wideLength;
+	}
+
+	// Whether the text may be used as the format in place of the key, see isTranslatedFormatValid
+	bool IsUsableAsFormat() const
+	{
+		return (m_pRecord->flags & BUNDLE_RECORD_FORMAT) != 0;
+	}
+
+private:
+	const BundleRecord* m_pRecord = nullptr;
+	const char* m_pText           = nullptr;
+	const char16_t* m_pWideText   = nullptr;
+	const uint32_t* m_pU32Pool    = nullptr;
+};
+
+class TranslationBundle
+{
+public:
+	TranslationBundle() = default;
+
+	TranslationBundle(const TranslationBundle&)            = delete;
+	TranslationBundle& operator=(const TranslationBundle&) = delete;
+
+	//
+	// Map a packed bundle from disk, the mapping is owned by this bundle. The packer
+	// replaces the file by renaming a new one over it, which leaves the mapping of a
+	// running game intact, so a bundle in use never changes under its readers.
+	//
+	bool Open(const std::filesystem::path& path)
+	{
+		Clear();
+
+		if (!m_file.Open(path))
+			return false;
+
+		if (!attach(m_file.GetData(), m_file.GetSize()))
+		{
+			Clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	// Take over a bundle that was compiled in memory from the JSON files
+	bool Load(std::vector<char>&& data)
+	{
+		Clear();
+
+		m_buffer = std::move(data);
+		if (!attach(m_buffer.data(), m_buffer.size()))
+		{
+			Clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	void Clear()
+	{
+		m_pHeader = nullptr;
+		m_pBase   = nullptr;
+		m_file.Close();
+#if INCLUDE_DEBUG_LOGGING
+		m_lookups.store(0, std::memory_order_relaxed);
+		m_hits.store(0, std::memory_order_relaxed);
+		m_filterSkips.store(0, std::memory_order_relaxed);
+#endif
+		m_buffer.clear();
+		m_buffer.shrink_to_fit();
+	}
+
+	bool IsLoaded() const
+	{
+		return m_pHeader != nullptr;
+	}
+
+	BundleKeyEncoding GetKeyEncoding() const
+	{
+		return m_pHeader ? static_cast<BundleKeyEncoding>(m_pHeader->keyEncoding) : BundleKeyEncoding::CP932;
+	}
+
+	std::size_t Size() const
+	{
+		return m_pHeader ? m_pHeader->records.count : 0;
+	}
+
+	// Look up a null terminated key, the hash and the length are determined in a single pass.
+	// Keys are hashed by their little endian byte representation, which matches the in
+	// memory layout of the narrow and wide strings the hooks receive.
+	template<typename CharT>
+	TranslationRecord Find(const CharT* pKey) const
+	{
+		if (pKey == nullptr || m_pHeader == nullptr)
+			return {};
+
+		count(m_lookups);
+
+		if (!mayContain(getBundleKeyPrefix(pKey)))
+		{
+			count(m_filterSkips);
+			return {};
+		}
+
+		uint64_t hash      = BUNDLE_FNV_OFFSET;
+		const CharT* pUnit = pKey;
+		while (*pUnit)
+		{
+			for (std::size_t i = 0; i < sizeof(CharT); i++)
+			{
+				hash ^= static_cast<uint8_t>(static_cast<std::make_unsigned_t<CharT>>(*pUnit) >> (i * 8));
+				hash *= BUNDLE_FNV_PRIME;
+			}
+
+			pUnit++;
+		}
+
+		return find(hash, reinterpret_cast<const char*>(pKey), static_cast<std::size_t>(pUnit - pKey) * sizeof(CharT));
+	}
+
+	TranslationRecord Find(const char* pKey, const std::size_t& length) const
+	{
+		if (m_pHeader == nullptr)
+			return {};
+
+		count(m_lookups);
+
+		if (!mayContain(getBundleKeyPrefix(pKey, length)))
+		{
+			count(m_filterSkips);
+			return {};
+		}
+
+		return find(hashBundleKey(pKey, length), pKey, length);
+	}
+
+	// Direct access by record index, the index must be below Size()
+	TranslationRecord GetRecord(const uint32_t& index) const
+	{
+		return makeRecord(section<BundleRecord>(m_pHeader->records)[index]);
+	}
+
+	uint32_t GetRecordIndex(const TranslationRecord& record) const
+	{
+		return static_cast<uint32_t>(record.m_pRecord - section<BundleRecord>(m_pHeader->records));
+	}
+
+	// Pattern files, see TranslationTemplates
+	std::size_t GetTemplateGroupCount() const
+	{
+		return m_pHeader ? m_pHeader->templateGroups.count / 2 : 0;
+	}
+
+	const uint32_t* GetTemplateGroups() const
+	{
+		return m_pHeader ? section<uint32_t>(m_pHeader->templateGroups) : nullptr;
+	}
+
+	const char16_t* GetTemplateStrings() const
+	{
+		return m_pHeader ? section<char16_t>(m_pHeader->templateStrings) : nullptr;
+	}
+
+	std::size_t GetTemplateStringsLength() const
+	{
+		return m_pHeader ? m_pHeader->templateStrings.count : 0;
+	}
+
+	BundleLookupStats GetLookupStats() const
+	{
+		BundleLookupStats stats;
+
+#if INCLUDE_DEBUG_LOGGING
+		// A lookup is counted before its outcome, so load the outcomes first
+		stats.hits           = m_hits.load(std::memory_order_relaxed);
+		stats.filterSkips    = m_filterSkips.load(std::memory_order_relaxed);
+		stats.lookups        = m_lookups.load(std::memory_order_relaxed);
+		stats.falsePositives = stats.lookups - stats.hits - stats.filterSkips;
+#endif
+
+		return stats;
+	}
+
+private:
+	//
+	// The counters are shared by all threads and sit on the same cache line, so they are
+	// only updated in builds with debug logging and the lookups of release builds stay free
+	// of atomic writes
+	//
+	void count([[maybe_unused]] std::atomic<uint64_t>& counter) const
+	{
+#if INCLUDE_DEBUG_LOGGING
+		counter.fetch_add(1, std::memory_order_relaxed);
+#endif
+	}
+
+	template<typename T>
+	const T* section(const BundleSection& sec) const
+	{
+		return reinterpret_cast<const T*>(m_pBase + sec.offset);
+	}
+
+	static bool sectionValid(const BundleSection& sec, const std::size_t& elementSize, const std::size_t& alignment, const std::size_t& size)
+	{
+		return sec.offset % alignment == 0 && static_cast<uint64_t>(sec.offset) + static_cast<uint64_t>(sec.count) * elementSize <= size;
+	}
+
+	bool attach(const char* pData, const std::size_t& size)
+	{
+		if (pData == nullptr || size < sizeof(BundleHeader))
+			return false;
+
+		const BundleHeader* pHeader = reinterpret_cast<const BundleHeader*>(pData);
+		if (pHeader->magic != BUNDLE_MAGIC || pHeader->version != BUNDLE_VERSION || pHeader->fileSize != size)
+			return false;
+
+		// Only the section bounds are checked, the records are trusted to keep the load time constant
+		if (!sectionValid(pHeader->filter, sizeof(uint64_t), alignof(uint64_t), size)
+			|| !sectionValid(pHeader->buckets, sizeof(uint32_t), alignof(uint32_t), size)
+			|| !sectionValid(pHeader->fingerprints, sizeof(uint32_t), alignof(uint32_t), size)
+			|| !sectionValid(pHeader->records, sizeof(BundleRecord), alignof(BundleRecord), size)
+			|| !sectionValid(pHeader->u32Pool, sizeof(uint32_t), alignof(uint32_t), size)
+			|| !sectionValid(pHeader->widePool, sizeof(char16_t), alignof(char16_t), size)
+			|| !sectionValid(pHeader->keyPool, 1, 1, size)
+			|| !sectionValid(pHeader->sjisPool, 1, 1, size)
+			|| !sectionValid(pHeader->templateGroups, sizeof(uint32_t), alignof(uint32_t), size)
+			|| !sectionValid(pHeader->templateStrings, sizeof(char16_t), alignof(char16_t), size))
+			return false;
+
+		if (pHeader->filter.count == 0 || pHeader->buckets.count == 0 || pHeader->fingerprints.count != pHeader->records.count || pHeader->templateGroups.count % 2 != 0)
+			return false;
+
+		m_pHeader = pHeader;
+		m_pBase   = pData;
+
+		return true;
+	}
+
+	bool mayContain(const uint64_t& prefix) const
+	{
+		const uint64_t prefixHash = mixBundleHash(prefix);
+		const uint64_t mask       = getBundleFilterMask(prefixHash);
+		return (section<uint64_t>(m_pHeader->filter)[getBundleFilterWord(prefixHash, m_pHeader->filter.count)] & mask) == mask;
+	}
+
+	TranslationRecord find(const uint64_t& hash, const char* pKey, const std::size_t& length) const
+	{
+		const uint32_t recordCount = m_pHeader->records.count;
+		if (recordCount == 0)
+			return {};
+
+		const uint32_t* pSeeds = section<uint32_t>(m_pHeader->buckets);
+		const uint32_t seed    = pSeeds[getBundleBucket(hash, m_pHeader->buckets.count)];
+		const uint32_t slot    = getBundleSlot(hash, seed, recordCount);
+
+		// Every key maps to some slot, the fingerprint rejects almost all misses
+		// before the record and the key pool are touched
+		if (section<uint32_t>(m_pHeader->fingerprints)[slot] != getBundleFingerprint(hash))
+			return {};
+
+		const BundleRecord& record = section<BundleRecord>(m_pHeader->records)[slot];
+		if (record.keyLength != length || std::memcmp(section<char>(m_pHeader->keyPool) + record.keyOffset, pKey, length) != 0)
+			return {};
+
+		count(m_hits);
+		return makeRecord(record);
+	}
+
+	TranslationRecord makeRecord(const BundleRecord& record) const
+	{
+		TranslationRecord result;
+		result.m_pRecord   = &record;
+		result.m_pText     = section<char>(m_pHeader->sjisPool) + record.textOffset;
+		result.m_pWideText = section<char16_t>(m_pHeader->widePool) + record.wideOffset;
+		result.m_pU32Pool  = section<uint32_t>(m_pHeader->u32Pool);
+		return result;
+	}
+
+private:
+	const BundleHeader* m_pHeader = nullptr;
+	const char* m_pBase           = nullptr;
+	MappedFile m_file;
+	std::vector<char> m_buffer;
+
+	mutable std::atomic<uint64_t> m_lookups     = 0;
+	mutable std::atomic<uint64_t> m_hits        = 0;
+	mutable std::atomic<uint64_t> m_filterSkips = 0;
+};
+
+//
+// Collects the translations and lays them out in the bundle format.
+// Adding a key twice replaces the earlier entry.
+//
+// The texts are interned in arenas, so identical translations are stored and
+// written to the bundle only once, and records share them by offset and length.
+//
+class TranslationBundleBuilder
+{
+	struct Entry
+	{
+		std::string_view key;
+		std::string_view sjisText;
+		std::u16string_view wideText;
+		std::vector<uint32_t> pixelLengths;
+		bool usableAsFormat;
+	};
+
+	struct TemplateGroup
+	{
+		std::vector<std::pair<std::u16string, std::u16string>> patterns;
+		std::vector<std::pair<std::u16string, std::u16string>> data;
+	};
+
+public:
+	explicit TranslationBundleBuilder(const BundleKeyEncoding& keyEncoding) :
+		m_keyEncoding(keyEncoding)
+	{
+	}
+
+	BundleKeyEncoding GetKeyEncoding() const
+	{
+		return m_keyEncoding;
+	}
+
+	void Add(const std::string_view& key, const std::string_view& sjisText, const std::u16string_view& wideText, std::vector<uint32_t> pixelLengths = {}, const bool& usableAsFormat = true)
+	{
+		Entry entry = { key, m_texts.Intern(sjisText), m_wideTexts.Intern(wideText), std::move(pixelLengths), usableAsFormat };
+
+		const auto it = m_keyIndices.find(key);
+		if (it != m_keyIndices.end())
+		{
+			entry.key             = it->first;
+			m_entries[it->second] = std::move(entry);
+			return;
+		}
+
+		// Keys are unique, so looking for an identical one is not needed
+		entry.key = m_keys.Store(key);
+
+		m_keyIndices.emplace(entry.key, m_entries.size());
+		m_entries.push_back(std::move(entry));
+	}
+
+	std::size_t Size() const
+	{
+		return m_entries.size();
+	}
+
+	// Add all entries of another builder, its entries replace existing ones with the same key
+	void Merge(TranslationBundleBuilder&& other)
+	{
+		for (Entry& entry : other.m_entries)
+			Add(entry.key, entry.sjisText, entry.wideText, std::move(entry.pixelLengths), entry.usableAsFormat);
+
+		for (TemplateGroup& group : other.m_templateGroups)
+			m_templateGroups.push_back(std::move(group));
+
+		other.m_entries.clear();
+		other.m_keyIndices.clear();
+		other.m_templateGroups.clear();
+		other.m_keys.Release();
+		other.m_texts.Release();
+		other.m_wideTexts.Release();
+	}
+
+	// Store a pattern file as is, it is compiled when the bundle is loaded
+	void AddTemplates(std::vector<std::pair<std::u16string, std::u16string>> patterns, std::vector<std::pair<std::u16string, std::u16string>> data)
+	{
+		m_templateGroups.push_back({ std::move(patterns), std::move(data) });
+	}
+
+	std::size_t GetTemplateCount() const
+	{
+		std::size_t count = 0;
+		for (const TemplateGroup& group : m_templateGroups)
+			count += group.patterns.size();
+
+		return count;
+	}
+
+	std::vector<char> Build() const
+	{
+		std::vector<BundleRecord> records;
+		std::vector<uint32_t> u32Pool;
+		std::u16string widePool;
+		std::string keyPool;
+		std::string sjisPool;
+
+		// Interned texts are identical exactly if they share their address
+		std::unordered_map<const char*, BundleRecord> textRecords;
+		std::unordered_map<const char16_t*, uint32_t> wideOffsets;
+
+		records.reserve(m_entries.size());
+
+		for (const Entry& entry : m_entries)
+		{
+			BundleRecord record = {};
+
+			record.keyOffset = static_cast<uint32_t>(keyPool.size());
+			record.keyLength = static_cast<uint32_t>(entry.key.size());
+			record.flags     = entry.usableAsFormat ? BUNDLE_RECORD_FORMAT : 0;
+			keyPool.append(entry.key);
+
+			record.pixelOffset = static_cast<uint32_t>(u32Pool.size());
+			record.pixelCount  = static_cast<uint32_t>(entry.pixelLengths.size());
+			u32Pool.insert(u32Pool.end(), entry.pixelLengths.begin(), entry.pixelLengths.end());
+
+			record.wideLength = static_cast<uint32_t>(entry.wideText.size());
+
+			const auto wideIt = wideOffsets.find(entry.wideText.data());
+			if (wideIt != wideOffsets.end())
+				record.wideOffset = wideIt->second;
+			else
+			{
+				record.wideOffset = static_cast<uint32_t>(widePool.size());
+				widePool.append(entry.wideText);
+				widePool.push_back(u'\0');
+				wideOffsets.emplace(entry.wideText.data(), record.wideOffset);
+			}
+
+			// The text and its lines are shared by all records with the same translation
+			const auto textIt = textRecords.find(entry.sjisText.data());
+			if (textIt != textRecords.end())
+			{
+				record.textOffset = textIt->second.textOffset;
+				record.textLength = textIt->second.textLength;
+				record.lineOffset = textIt->second.lineOffset;
+				record.lineCount  = textIt->second.lineCount;
+
+				records.push_back(record);
+				continue;
+			}
+
+			record.textOffset = static_cast<uint32_t>(sjisPool.size());
+			record.textLength = static_cast<uint32_t>(entry.sjisText.size());
+			sjisPool.append(entry.sjisText);
+			sjisPool.push_back('\0');
+
+			// Append a copy of the text with every line null terminated
+			record.lineOffset = static_cast<uint32_t>(u32Pool.size());
+			record.lineCount  = 1;
+			u32Pool.push_back(static_cast<uint32_t>(sjisPool.size() - record.textOffset));
+
+			for (const char& c : entry.sjisText)
+			{
+				// Trail bytes of CP932 double byte characters never use values below 0x40,
+				// so a '\n' byte is always a real line break
+				if (c == '\n')
+				{
+					sjisPool.push_back('\0');
+					u32Pool.push_back(static_cast<uint32_t>(sjisPool.size() - record.textOffset));
+					record.lineCount++;
+				}
+				else
+					sjisPool.push_back(c);
+			}
+
+			sjisPool.push_back('\0');
+
+			textRecords.emplace(entry.sjisText.data(), record);
+			records.push_back(record);
+		}
+
+		std::vector<uint64_t> hashes(records.size());
+		for (std::size_t i = 0; i < records.size(); i++)
+			hashes[i] = hashBundleKey(keyPool.data() + records[i].keyOffset, records[i].keyLength);
+
+		std::vector<uint32_t> seeds;
+		const std::vector<uint32_t> slots = buildPerfectHash(hashes, seeds);
+
+		// Store the records in slot order, so the slot directly addresses the record
+		std::vector<BundleRecord> orderedRecords(records.size());
+		std::vector<uint32_t> fingerprints(records.size());
+		for (std::size_t i = 0; i < records.size(); i++)
+		{
+			orderedRecords[slots[i]] = records[i];
+			fingerprints[slots[i]]   = getBundleFingerprint(hashes[i]);
+		}
+
+		const uint32_t filterWords = std::max<uint32_t>(1, static_cast<uint32_t>((records.size() * BUNDLE_FILTER_BITS + 63) / 64));
+		std::vector<uint64_t> filter(filterWords, 0);
+		for (const BundleRecord& record : records)
+		{
+			const uint64_t prefixHash = mixBundleHash(getBundleKeyPrefix(keyPool.data() + record.keyOffset, record.keyLength));
+			filter[getBundleFilterWord(prefixHash, filterWords)] |= getBundleFilterMask(prefixHash);
+		}
+
+		std::vector<uint32_t> templateGroups;
+		std::u16string templateStrings;
+		for (const TemplateGroup& group : m_templateGroups)
+		{
+			templateGroups.push_back(static_cast<uint32_t>(group.patterns.size()));
+			templateGroups.push_back(static_cast<uint32_t>(group.data.size()));
+
+			for (const auto& strings : { &group.patterns, &group.data })
+			{
+				for (const auto& [first, second] : *strings)
+				{
+					templateStrings.append(first);
+					templateStrings.push_back(u'\0');
+					templateStrings.append(second);
+					templateStrings.push_back(u'\0');
+				}
+			}
+		}
+
+		BundleHeader header = {};
+		header.keyEncoding  = static_cast<uint32_t>(m_keyEncoding);
+
+		uint64_t offset = sizeof(BundleHeader);
+		header.filter          = placeSection(offset, filter.size(), sizeof(uint64_t));
+		header.buckets         = placeSection(offset, seeds.size(), sizeof(uint32_t));
+		header.fingerprints    = placeSection(offset, fingerprints.size(), sizeof(uint32_t));
+		header.records         = placeSection(offset, orderedRecords.size(), sizeof(BundleRecord));
+		header.u32Pool         = placeSection(offset, u32Pool.size(), sizeof(uint32_t));
+		header.widePool        = placeSection(offset, widePool.size(), sizeof(char16_t));
+		header.keyPool         = placeSection(offset, keyPool.size(), 1);
+		header.sjisPool        = placeSection(offset, sjisPool.size(), 1);
+		header.templateGroups  = placeSection(offset, templateGroups.size(), sizeof(uint32_t));
+		header.templateStrings = placeSection(offset, templateStrings.size(), sizeof(char16_t));
+
+		if (offset > UINT32_MAX)
+			throw std::runtime_error("Translation bundle exceeds 4 GiB");
+
+		header.fileSize = static_cast<uint32_t>(offset);
+
+		std::vector<char> data(static_cast<std::size_t>(offset), 0);
+		std::memcpy(data.data(), &header, sizeof(header));
+		writeSection(data, header.filter, filter.data(), sizeof(uint64_t));
+		writeSection(data, header.buckets, seeds.data(), sizeof(uint32_t));
+		writeSection(data, header.fingerprints, fingerprints.data(), sizeof(uint32_t));
+		writeSection(data, header.records, orderedRecords.data(), sizeof(BundleRecord));
+		writeSection(data, header.u32Pool, u32Pool.data(), sizeof(uint32_t));
+		writeSection(data, header.widePool, widePool.data(), sizeof(char16_t));
+		writeSection(data, header.keyPool, keyPool.data(), 1);
+		writeSection(data, header.sjisPool, sjisPool.data(), 1);
+		writeSection(data, header.templateGroups, templateGroups.data(), sizeof(uint32_t));
+		writeSection(data, header.templateStrings, templateStrings.data(), sizeof(char16_t));
+
+		return data;
+	}
+
+private:
+	//
+	// Assign every hash a distinct slot in [0, hashes.size()).
+	// Buckets are placed largest first, each one trying seeds until all of its
+	// keys land in free slots. Returns the slot of every hash.
+	//
+	static std::vector<uint32_t> buildPerfectHash(const std::vector<uint64_t>& hashes, std::vector<uint32_t>& seeds)
+	{
+		static constexpr uint32_t MAX_SEED = 1u << 28;
+
+		const uint32_t keyCount    = static_cast<uint32_t>(hashes.size());
+		const uint32_t bucketCount = std::max<uint32_t>(1, (keyCount + BUNDLE_BUCKET_SIZE - 1) / BUNDLE_BUCKET_SIZE);
+
+		std::vector<std::vector<uint32_t>> buckets(bucketCount);
+		for (uint32_t i = 0; i < keyCount; i++)
+			buckets[getBundleBucket(hashes[i], bucketCount)].push_back(i);
+
+		std::vector<uint32_t> order(bucketCount);
+		for (uint32_t i = 0; i < bucketCount; i++)
+			order[i] = i;
+
+		std::stable_sort(order.begin(), order.end(), [&buckets](const uint32_t& a, const uint32_t& b) { return buckets[a].size() > buckets[b].size(); });
+
+		seeds.assign(bucketCount, 0);
+		std::vector<uint32_t> slots(keyCount, 0);
+		std::vector<bool> taken(keyCount, false);
+		std::vector<uint32_t> candidates;
+
+		for (const uint32_t& bucketIndex : order)
+		{
+			const std::vector<uint32_t>& bucket = buckets[bucketIndex];
+			if (bucket.empty())
+				break;
+
+			// Two different keys with the same 64 bit hash can never be separated
+			for (std::size_t i = 0; i < bucket.size(); i++)
+			{
+				for (std::size_t j = i + 1; j < bucket.size(); j++)
+				{
+					if (hashes[bucket[i]] == hashes[bucket[j]])
+						throw std::runtime_error("Translation keys with identical hashes");
+				}
+			}
+
+			uint32_t seed = 0;
+			for (;; seed++)
+			{
+				if (seed == MAX_SEED)
+					throw std::runtime_error("Unable to build the perfect hash for the translation keys");
+
+				candidates.clear();
+
+				bool valid = true;
+				for (const uint32_t& key : bucket)
+				{
+					const uint32_t slot = getBundleSlot(hashes[key], seed, keyCount);
+					if (taken[slot] || std::find(candidates.begin(), candidates.end(), slot) != candidates.end())
+					{
+						valid = false;
+						break;
+					}
+
+					candidates.push_back(slot);
+				}
+
+				if (valid)
+					break;
+			}
+
+			seeds[bucketIndex] = seed;
+			for (std::size_t i = 0; i < bucket.size(); i++)
+			{
+				slots[bucket[i]]     = candidates[i];
+				taken[candidates[i]] = true;
+			}
+		}
+
+		return slots;
+	}
+
+	static BundleSection placeSection(uint64_t& offset, const std::size_t& count, const std::size_t& elementSize)
+	{
+		offset = (offset + 7) & ~static_cast<uint64_t>(7);
+
+		BundleSection sec;
+		sec.offset = static_cast<uint32_t>(offset);
+		sec.count  = static_cast<uint32_t>(count);
+
+		offset += static_cast<uint64_t>(count) * elementSize;
+		return sec;
+	}
+
+	static void writeSection(std::vector<char>& data, const BundleSection& sec, const void* pSrc, const std::size_t& elementSize)
+	{
+		if (sec.count != 0)
+			std::memcpy(data.data() + sec.offset, pSrc, static_cast<std::size_t>(sec.count) * elementSize);
+	}
+
+private:
+	BundleKeyEncoding m_keyEncoding;
+	std::vector<Entry> m_entries;
+	std::unordered_map<std::string_view, std::size_t> m_keyIndices;
+
+	StringArena m_keys;
+	StringArena m_texts;
+	U16StringArena m_wideTexts;
+	std::vector<TemplateGroup> m_templateGroups;
+};
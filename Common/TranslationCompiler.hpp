@@ -0,0 +1,517 @@
+/*
+ *  File: TranslationCompiler.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "PrintfFormat.hpp"
+#include "TranslationBundle.hpp"
+#include "TranslationTemplates.hpp"
+
+inline const std::string WINDOW_TITLE_KEY = "window_title";
+
+//
+// Converters from the UTF-8 strings in the JSON files to the bundle encodings.
+// A missing converter leaves the corresponding text pool empty.
+//
+struct TranslationEncoders
+{
+	std::function<std::string(const std::string&)> toSjis;
+	std::function<std::u16string(const std::string&)> toWide;
+};
+
+inline std::string encodeBundleKey(const std::string& key, const BundleKeyEncoding& keyEncoding, const TranslationEncoders& encoders)
+{
+	if (keyEncoding == BundleKeyEncoding::UTF16)
+	{
+		const std::u16string wideKey = encoders.toWide(key);
+		return std::string(reinterpret_cast<const char*>(wideKey.data()), wideKey.size() * sizeof(char16_t));
+	}
+
+	return encoders.toSjis(key);
+}
+
+//
+// Add a translation to the bundle. Every entry is added, but only translations that read
+// the same arguments as their original are flagged as usable as its format. The hooks
+// use the others as text only, e.g. "10% damage" is no format even though it parses as
+// one. Returns false if the translation can not be used as a format.
+//
+inline bool addBundleEntry(TranslationBundleBuilder& builder, const TranslationEncoders& encoders, const std::string& key, const std::string& text, std::vector<uint32_t> pixelLengths = {})
+{
+	const bool usableAsFormat = isTranslatedFormatValid(key, text);
+
+	builder.Add(encodeBundleKey(key, builder.GetKeyEncoding(), encoders),
+				encoders.toSjis ? encoders.toSjis(text) : std::string(),
+				encoders.toWide ? encoders.toWide(text) : std::u16string(),
+				std::move(pixelLengths),
+				usableAsFormat);
+
+	return usableAsFormat;
+}
+
+// Thrown for malformed JSON, as opposed to valid JSON with invalid translations
+class TranslationParseError : public std::runtime_error
+{
+public:
+	using std::runtime_error::runtime_error;
+};
+
+//
+// Base of the streaming handlers, the translation files are parsed with the SAX
+// interface of nlohmann::json so no DOM is ever built. Every callback ignores
+// its value unless the derived handler overrides it.
+//
+class TranslationSaxHandler : public nlohmann::json_sax<nlohmann::json>
+{
+public:
+	bool null() override
+	{
+		return true;
+	}
+
+	bool boolean(bool) override
+	{
+		return true;
+	}
+
+	bool number_integer(number_integer_t value) override
+	{
+		return number(static_cast<double>(value));
+	}
+
+	bool number_unsigned(number_unsigned_t value) override
+	{
+		return number(static_cast<double>(value));
+	}
+
+	bool number_float(number_float_t value, const string_t&) override
+	{
+		return number(static_cast<double>(value));
+	}
+
+	bool binary(binary_t&) override
+	{
+		return true;
+	}
+
+	bool start_object(std::size_t) override
+	{
+		m_depth++;
+		return true;
+	}
+
+	bool end_object() override
+	{
+		m_depth--;
+		return true;
+	}
+
+	bool start_array(std::size_t) override
+	{
+		m_depth++;
+		return true;
+	}
+
+	bool end_array() override
+	{
+		m_depth--;
+		return true;
+	}
+
+	bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override
+	{
+		m_error = ex.what();
+		return false;
+	}
+
+	void Parse(std::istream& input)
+	{
+		if (!nlohmann::json::sax_parse(input, this))
+			throw TranslationParseError(m_error.empty() ? "Unexpected end of the translation file" : m_error);
+	}
+
+protected:
+	virtual bool number([[maybe_unused]] const double& value)
+	{
+		return true;
+	}
+
+protected:
+	int32_t m_depth = 0;
+	std::string m_error;
+};
+
+//
+// EternalRedirect catalogue:
+//   { "<original>": { "text": "<translation>", "pixel_lengths": [ ... ] }, "window_title": "<title>" }
+// Every entry is added to the builder as soon as its object is closed.
+//
+class EternalSaxHandler : public TranslationSaxHandler
+{
+public:
+	EternalSaxHandler(TranslationBundleBuilder& builder, const TranslationEncoders& encoders) :
+		m_builder(builder), m_encoders(encoders)
+	{
+	}
+
+	bool key(string_t& val) override
+	{
+		if (m_depth == 1)
+			m_key = std::move(val);
+		else if (m_depth == 2)
+			m_field = std::move(val);
+
+		return true;
+	}
+
+	bool string(string_t& val) override
+	{
+		if (m_depth == 1 && m_key == WINDOW_TITLE_KEY)
+			add(m_key, val, {});
+		else if (m_depth == 2 && m_field == "text")
+		{
+			m_text    = std::move(val);
+			m_hasText = true;
+		}
+
+		return true;
+	}
+
+	bool start_object(std::size_t size) override
+	{
+		TranslationSaxHandler::start_object(size);
+
+		if (m_depth == 2)
+		{
+			m_text.clear();
+			m_pixelLengths.clear();
+			m_hasText         = false;
+			m_hasPixelLengths = false;
+		}
+
+		return true;
+	}
+
+	bool end_object() override
+	{
+		if (m_depth == 2 && m_hasText && m_hasPixelLengths)
+			add(m_key, m_text, std::move(m_pixelLengths));
+
+		return TranslationSaxHandler::end_object();
+	}
+
+	bool start_array(std::size_t size) override
+	{
+		TranslationSaxHandler::start_array(size);
+
+		if (m_depth == 3 && m_field == "pixel_lengths")
+			m_hasPixelLengths = true;
+
+		return true;
+	}
+
+	// Keys of the entries whose translation is not usable as a format, see addBundleEntry
+	const std::vector<std::string>& GetTextOnlyKeys() const
+	{
+		return m_textOnlyKeys;
+	}
+
+protected:
+	bool number(const double& value) override
+	{
+		if (m_depth == 3 && m_field == "pixel_lengths")
+			m_pixelLengths.push_back(static_cast<uint32_t>(value));
+
+		return true;
+	}
+
+private:
+	void add(const std::string& key, const std::string& text, std::vector<uint32_t> pixelLengths)
+	{
+		if (!addBundleEntry(m_builder, m_encoders, key, text, std::move(pixelLengths)))
+			m_textOnlyKeys.push_back(key);
+	}
+
+private:
+	TranslationBundleBuilder& m_builder;
+	const TranslationEncoders& m_encoders;
+	std::vector<std::string> m_textOnlyKeys;
+
+	std::string m_key;
+	std::string m_field;
+	std::string m_text;
+	std::vector<uint32_t> m_pixelLengths;
+	bool m_hasText         = false;
+	bool m_hasPixelLengths = false;
+};
+
+//
+// DemonionRedirect catalogue, either a flat { "<original>": "<translation>" } object
+// or a pattern file, which is stored as is and matched at lookup time:
+//   { "patterns": { "<original pattern>": "<translated pattern>" }, "data": { "<original>": "<translation>" } }
+// Which of both a file is only known at its end, so the strings are collected first.
+//
+class RedirectSaxHandler : public TranslationSaxHandler
+{
+	using StringPairs = std::vector<std::pair<std::string, std::string>>;
+
+public:
+	bool key(string_t& val) override
+	{
+		if (m_depth == 1)
+			m_key = std::move(val);
+		else if (m_depth == 2)
+			m_field = std::move(val);
+
+		return true;
+	}
+
+	bool string(string_t& val) override
+	{
+		if (m_depth == 1)
+			m_entries.emplace_back(m_key, std::move(val));
+		else if (m_depth == 2 && m_pSection != nullptr)
+			m_pSection->emplace_back(m_field, std::move(val));
+
+		return true;
+	}
+
+	bool start_object(std::size_t size) override
+	{
+		TranslationSaxHandler::start_object(size);
+
+		if (m_depth == 2 && m_key == "patterns")
+		{
+			m_pSection    = &m_patterns;
+			m_hasPatterns = true;
+		}
+		else if (m_depth == 2 && m_key == "data")
+		{
+			m_pSection = &m_data;
+			m_hasData  = true;
+		}
+
+		return true;
+	}
+
+	bool end_object() override
+	{
+		if (m_depth == 2)
+			m_pSection = nullptr;
+
+		return TranslationSaxHandler::end_object();
+	}
+
+	// Returns the keys of the entries whose translation is not usable as a format, see addBundleEntry
+	std::vector<std::string> Compile(TranslationBundleBuilder& builder, const TranslationEncoders& encoders) const
+	{
+		std::vector<std::string> textOnlyKeys;
+
+		if (!m_hasPatterns || !m_hasData)
+		{
+			for (const auto& [key, value] : m_entries)
+			{
+				if (!addBundleEntry(builder, encoders, key, value))
+					textOnlyKeys.push_back(key);
+			}
+
+			return textOnlyKeys;
+		}
+
+		if (!encoders.toWide)
+			throw std::runtime_error("Pattern files require UTF-16 texts");
+
+		std::vector<std::pair<std::u16string, std::u16string>> patterns;
+		std::vector<std::pair<std::u16string, std::u16string>> data;
+
+		for (const auto& [original, translated] : m_patterns)
+		{
+			patterns.emplace_back(encoders.toWide(original), encoders.toWide(translated));
+
+			// Reject invalid patterns when compiling instead of when loading the bundle
+			try
+			{
+				compilePattern(patterns.back().first);
+				compilePattern(patterns.back().second);
+			}
+			catch (const std::runtime_error& e)
+			{
+				throw std::runtime_error(std::string(e.what()) + ": " + original + " -> " + translated);
+			}
+		}
+
+		for (const auto& [key, value] : m_data)
+			data.emplace_back(encoders.toWide(key), encoders.toWide(value));
+
+		builder.AddTemplates(std::move(patterns), std::move(data));
+		return textOnlyKeys;
+	}
+
+private:
+	std::string m_key;
+	std::string m_field;
+
+	StringPairs m_entries;
+	StringPairs m_patterns;
+	StringPairs m_data;
+	StringPairs* m_pSection = nullptr;
+	bool m_hasPatterns      = false;
+	bool m_hasData          = false;
+};
+
+//
+// Compile a translation file into the builder. Returns the keys of the entries whose
+// translation does not read the arguments of the original format, they are used as text only.
+//
+inline std::vector<std::string> compileEternalTranslations(std::istream& input, TranslationBundleBuilder& builder, const TranslationEncoders& encoders)
+{
+	EternalSaxHandler handler(builder, encoders);
+	handler.Parse(input);
+	return handler.GetTextOnlyKeys();
+}
+
+inline std::vector<std::string> compileRedirectTranslations(std::istream& input, TranslationBundleBuilder& builder, const TranslationEncoders& encoders)
+{
+	RedirectSaxHandler handler;
+	handler.Parse(input);
+	return handler.Compile(builder, encoders);
+}
+
+//
+// The JSON files of a translation directory in priority order, i.e. sorted by name.
+// Later files override earlier ones, so the result does not depend on the file system.
+//
+inline std::vector<std::filesystem::path> collectTranslationFiles(const std::filesystem::path& path)
+{
+	std::vector<std::filesystem::path> files;
+
+	if (!std::filesystem::is_directory(path))
+	{
+		files.push_back(path);
+		return files;
+	}
+
+	for (const auto& file : std::filesystem::directory_iterator(path))
+	{
+		if (file.is_regular_file() && file.path().extension() == ".json")
+			files.push_back(file.path());
+	}
+
+	std::sort(files.begin(), files.end());
+	return files;
+}
+
+//
+// A packed bundle is only used if none of the JSON files it was packed from were
+// changed after it, so an edited JSON file is picked up without repacking.
+//
+inline bool isBundleCurrent(const std::filesystem::path& bundlePath, const std::vector<std::filesystem::path>& sources)
+{
+	std::error_code ec;
+	const std::filesystem::file_time_type bundleTime = std::filesystem::last_write_time(bundlePath, ec);
+	if (ec)
+		return false;
+
+	for (const std::filesystem::path& source : sources)
+	{
+		const std::filesystem::file_time_type sourceTime = std::filesystem::last_write_time(source, ec);
+		if (!ec && sourceTime > bundleTime)
+			return false;
+	}
+
+	return true;
+}
+
+//
+// Compile the files concurrently, each into its own builder, and merge those in the
+// order of the files, so the last file wins independent of which finished first.
+// The first error in file order is rethrown after all workers finished.
+//
+inline void compileTranslationFiles(const std::vector<std::filesystem::path>& files, TranslationBundleBuilder& builder,
+									const std::function<void(const std::filesystem::path&, TranslationBundleBuilder&)>& compileFile, std::size_t threadCount = 0)
+{
+	static constexpr std::size_t MAX_THREADS = 8;
+
+	if (threadCount == 0)
+		threadCount = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), MAX_THREADS);
+
+	threadCount = std::min(threadCount, files.size());
+
+	std::vector<TranslationBundleBuilder> builders;
+	builders.reserve(files.size());
+	for (std::size_t i = 0; i < files.size(); i++)
+		builders.emplace_back(builder.GetKeyEncoding());
+	std::vector<std::exception_ptr> errors(files.size());
+	std::atomic<std::size_t> nextFile = 0;
+
+	const auto worker = [&]() {
+		for (std::size_t i = nextFile++; i < files.size(); i = nextFile++)
+		{
+			try
+			{
+				compileFile(files[i], builders[i]);
+			}
+			catch (...)
+			{
+				errors[i] = std::current_exception();
+			}
+		}
+	};
+
+	if (threadCount <= 1)
+		worker();
+	else
+	{
+		std::vector<std::thread> threads;
+		for (std::size_t i = 0; i < threadCount; i++)
+			threads.emplace_back(worker);
+
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	for (std::size_t i = 0; i < files.size(); i++)
+	{
+		if (errors[i])
+			std::rethrow_exception(errors[i]);
+
+		builder.Merge(std::move(builders[i]));
+	}
+}
@@ -0,0 +1,85 @@
+/*
+ *  File: TranslationLookup.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "PatternResultCache.hpp"
+#include "TranslationBundle.hpp"
+#include "TranslationTemplates.hpp"
+
+//
+// Translate a UTF-16 string of the DemonionRedirect catalogue. Direct translations take
+// precedence over the patterns, the pattern results are cached so the returned text stays
+// valid as long as the cache like a bundle text does. Strings no pattern matches are cached
+// as well, so a repeated miss costs one lookup.
+//
+// Returns the null terminated translation and its length or nullptr if there is none. Like
+// a missing one, an empty translation leaves the original string. For a format, translations
+// that do not read the same arguments as the key are not returned.
+//
+inline const char16_t* lookupTranslation(const TranslationBundle& translations, const TranslationTemplates& templates, PatternResultCache& patternResults,
+										 const std::u16string_view& key, std::size_t& length, const bool& asFormat = false)
+{
+	// Keys are stored as UTF-16, so the string is looked up as is
+	const TranslationRecord record = translations.Find(reinterpret_cast<const char*>(key.data()), key.size() * sizeof(char16_t));
+	if (record)
+	{
+		if (record.GetWideTextLength() == 0 || (asFormat && !record.IsUsableAsFormat()))
+			return nullptr;
+
+		length = record.GetWideTextLength();
+		return record.GetWideText();
+	}
+
+	if (templates.Empty())
+		return nullptr;
+
+	const std::u16string* pResult = patternResults.Find(key);
+	if (pResult == nullptr)
+	{
+		// Only valid until the next pattern match on this thread if the cache is full
+		thread_local std::u16string uncachedResult;
+		if (!templates.Find(key, uncachedResult) || uncachedResult.empty())
+		{
+			patternResults.InsertNoMatch(key);
+			return nullptr;
+		}
+
+		pResult = patternResults.Insert(key, uncachedResult);
+		if (pResult == nullptr)
+			pResult = &uncachedResult;
+	}
+
+	if (pResult == &PatternResultCache::NO_MATCH)
+		return nullptr;
+
+	length = pResult->size();
+	return pResult->c_str();
+}
@@ -0,0 +1,138 @@
+/*
+ *  File: TranslationPointerCache.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "TranslationBundle.hpp"
+
+//
+// Lookup cache keyed by the address of the source string
+//
+// Most strings the game hands to the hooks live in the read-only data of the
+// executable, so the same pointer returns with the same bytes every frame. The
+// cache maps such a pointer straight to its bundle record, or to a cached miss,
+// without hashing the string again.
+//
+// Only strings that never change may be looked up through the cache, e.g. those in
+// the read-only sections of the executable. A hit only compares the length and the
+// first and last byte, so a buffer the game rewrites in place, like "HP 100" becoming
+// "HP 150", would return the translation of its old content.
+//
+// Every slot is a pair of 64 bit words {pointer ^ data, data} that is written and
+// read without a lock. A torn read breaks the xor and is treated as a miss. The data
+// word holds the record, the length and the first and last byte of the string, which
+// are compared against the string before a cached result is used.
+//
+class TranslationPointerCache
+{
+	static constexpr std::size_t SLOT_COUNT = 4096;
+
+	static constexpr uint64_t FIELD_MASK = 0xFFFFFF; // Record index + 1 and length are 24 bits each
+
+	struct Slot
+	{
+		std::atomic<uint64_t> key  = 0;
+		std::atomic<uint64_t> data = 0;
+	};
+
+public:
+	TranslationPointerCache() = default;
+
+	TranslationPointerCache(const TranslationPointerCache&)            = delete;
+	TranslationPointerCache& operator=(const TranslationPointerCache&) = delete;
+
+	// Look up a null terminated string, the result is cached by its address
+	TranslationRecord Find(const TranslationBundle& bundle, const char* pKey)
+	{
+		if (pKey == nullptr)
+			return {};
+
+		const uint64_t address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(pKey));
+		Slot& slot             = m_slots[mixBundleHash(address) & (SLOT_COUNT - 1)];
+
+		const uint64_t data = slot.data.load(std::memory_order_relaxed);
+		const uint64_t key  = slot.key.load(std::memory_order_relaxed);
+
+		if ((key ^ data) == address && matches(pKey, data))
+		{
+			const uint64_t recordIndex = data & FIELD_MASK;
+			return recordIndex ? bundle.GetRecord(static_cast<uint32_t>(recordIndex - 1)) : TranslationRecord();
+		}
+
+		const TranslationRecord record = bundle.Find(pKey);
+		store(slot, address, pKey, record ? bundle.GetRecordIndex(record) + 1 : 0);
+
+		return record;
+	}
+
+	// Has to be called whenever the bundle the cached records belong to changes
+	void Clear()
+	{
+		for (Slot& slot : m_slots)
+		{
+			slot.key.store(0, std::memory_order_relaxed);
+			slot.data.store(0, std::memory_order_relaxed);
+		}
+	}
+
+private:
+	// The length check only reads p[length - 1] and p[length], so it is O(1)
+	static bool matches(const char* pKey, const uint64_t& data)
+	{
+		const std::size_t length = static_cast<std::size_t>((data >> 24) & FIELD_MASK);
+		const uint8_t first      = static_cast<uint8_t>(data >> 48);
+		const uint8_t last       = static_cast<uint8_t>(data >> 56);
+
+		if (length == 0)
+			return pKey[0] == '\0';
+
+		return static_cast<uint8_t>(pKey[0]) == first && static_cast<uint8_t>(pKey[length - 1]) == last && pKey[length] == '\0';
+	}
+
+	static void store(Slot& slot, const uint64_t& address, const char* pKey, const uint64_t& recordIndex)
+	{
+		const std::size_t length = std::strlen(pKey);
+
+		// Strings or bundles too large for the packed fields are simply not cached
+		if (length > FIELD_MASK || recordIndex > FIELD_MASK)
+			return;
+
+		uint64_t data = recordIndex | (static_cast<uint64_t>(length) << 24);
+		if (length != 0)
+			data |= (static_cast<uint64_t>(static_cast<uint8_t>(pKey[0])) << 48) | (static_cast<uint64_t>(static_cast<uint8_t>(pKey[length - 1])) << 56);
+
+		slot.key.store(address ^ data, std::memory_order_relaxed);
+		slot.data.store(data, std::memory_order_relaxed);
+	}
+
+private:
+	std::array<Slot, SLOT_COUNT> m_slots;
+};
@@ -0,0 +1,401 @@
+/*
+ *  File: TranslationTemplates.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "TranslationBundle.hpp"
+
+//
+// Pattern translations
+//
+// A pattern file pairs original patterns with translated patterns and a set of
+// data entries the placeholders stand for:
+//   { "patterns": { "{}を倒した": "Defeated {1}" }, "data": { "スライム": "Slime" } }
+// {0} refers to the original data entry, {1} to its translation and {} to the next one.
+//
+// Instead of expanding every pattern for every data entry, each pattern is parsed
+// into its literal segments once. A string is matched by its leading and trailing
+// literal, and the text in between is resolved through the data entries.
+//
+
+//
+// A parsed pattern, literals[i] precedes the placeholder arguments[i] and the last
+// literal follows the final placeholder
+//
+struct CompiledPattern
+{
+	std::vector<std::u16string> literals;
+	std::vector<uint8_t> arguments;
+};
+
+inline CompiledPattern compilePattern(const std::u16string_view& pattern)
+{
+	CompiledPattern result;
+	result.literals.emplace_back();
+
+	std::size_t nextArg = 0;
+	bool automatic      = false;
+	bool numbered       = false;
+
+	for (std::size_t i = 0; i < pattern.size(); i++)
+	{
+		const char16_t c = pattern[i];
+
+		if ((c == u'{' || c == u'}') && i + 1 < pattern.size() && pattern[i + 1] == c)
+		{
+			result.literals.back().push_back(c);
+			i++;
+			continue;
+		}
+
+		if (c == u'}')
+			throw std::runtime_error("Unmatched '}' in pattern");
+
+		if (c != u'{')
+		{
+			result.literals.back().push_back(c);
+			continue;
+		}
+
+		const std::size_t end = pattern.find(u'}', i);
+		if (end == std::u16string_view::npos)
+			throw std::runtime_error("Unmatched '{' in pattern");
+
+		const std::u16string_view argId = pattern.substr(i + 1, end - i - 1);
+		std::size_t arg                 = nextArg++;
+
+		if (argId == u"0" || argId == u"1")
+			arg = static_cast<std::size_t>(argId[0] - u'0');
+		else if (!argId.empty())
+			throw std::runtime_error("Unsupported placeholder in pattern");
+
+		// Like std::format, {} can not be combined with {0} and {1}
+		(argId.empty() ? automatic : numbered) = true;
+		if (automatic && numbered)
+			throw std::runtime_error("Mixed automatic and numbered placeholders in pattern");
+
+		if (arg > 1)
+			throw std::runtime_error("Too many placeholders in pattern");
+
+		result.arguments.push_back(static_cast<uint8_t>(arg));
+		result.literals.emplace_back();
+		i = end;
+	}
+
+	return result;
+}
+
+inline void formatPattern(const CompiledPattern& pattern, const std::u16string_view& key, const std::u16string_view& value, std::u16string& result)
+{
+	result.clear();
+
+	for (std::size_t i = 0; i < pattern.arguments.size(); i++)
+	{
+		result.append(pattern.literals[i]);
+		result.append(pattern.arguments[i] == 0 ? key : value);
+	}
+
+	result.append(pattern.literals.back());
+}
+
+class TranslationTemplates
+{
+	struct Group
+	{
+		std::unordered_map<std::u16string_view, std::u16string_view> values; // Original -> translation
+		std::unordered_map<std::u16string_view, std::u16string_view> keys;   // Translation -> original, only if a pattern matches on {1}
+	};
+
+	struct Template
+	{
+		uint32_t group;
+		CompiledPattern original;
+		CompiledPattern translated;
+	};
+
+public:
+	TranslationTemplates() = default;
+
+	TranslationTemplates(const TranslationTemplates&)            = delete;
+	TranslationTemplates& operator=(const TranslationTemplates&) = delete;
+
+	//
+	// Compile the pattern files stored in the bundle, the data entries are referenced
+	// in place so the bundle has to outlive the templates
+	//
+	bool Attach(const TranslationBundle& bundle)
+	{
+		Clear();
+
+		const uint32_t* pCounts      = bundle.GetTemplateGroups();
+		const char16_t* pStrings     = bundle.GetTemplateStrings();
+		const char16_t* const pEnd   = pStrings + bundle.GetTemplateStringsLength();
+		const std::size_t groupCount = bundle.GetTemplateGroupCount();
+
+		const auto nextString = [&pStrings, &pEnd](std::u16string_view& str) {
+			const char16_t* pStart = pStrings;
+			while (pStrings < pEnd && *pStrings)
+				pStrings++;
+
+			if (pStrings == pEnd)
+				return false;
+
+			str = std::u16string_view(pStart, static_cast<std::size_t>(pStrings - pStart));
+			pStrings++;
+			return true;
+		};
+
+		try
+		{
+			m_groups.resize(groupCount);
+
+			for (std::size_t g = 0; g < groupCount; g++)
+			{
+				const uint32_t patternCount = pCounts[g * 2];
+				const uint32_t dataCount    = pCounts[g * 2 + 1];
+				bool matchesValue           = false;
+
+				for (uint32_t i = 0; i < patternCount; i++)
+				{
+					std::u16string_view original;
+					std::u16string_view translated;
+					if (!nextString(original) || !nextString(translated))
+						throw std::runtime_error("Truncated template strings");
+
+					Template tmpl = { static_cast<uint32_t>(g), compilePattern(original), compilePattern(translated) };
+					for (const uint8_t& arg : tmpl.original.arguments)
+						matchesValue |= arg == 1;
+
+					m_index[indexKey(tmpl.original.literals.front(), tmpl.original.literals.back())].push_back(static_cast<uint32_t>(m_templates.size()));
+					m_templates.push_back(std::move(tmpl));
+				}
+
+				Group& group = m_groups[g];
+				group.values.reserve(dataCount);
+
+				for (uint32_t i = 0; i < dataCount; i++)
+				{
+					std::u16string_view key;
+					std::u16string_view value;
+					if (!nextString(key) || !nextString(value))
+						throw std::runtime_error("Truncated template strings");
+
+					group.values[key] = value;
+					if (matchesValue)
+						group.keys[value] = key;
+				}
+			}
+		}
+		catch (const std::exception&)
+		{
+			Clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	void Clear()
+	{
+		m_groups.clear();
+		m_templates.clear();
+		m_index.clear();
+	}
+
+	bool Empty() const
+	{
+		return m_templates.empty();
+	}
+
+	std::size_t Size() const
+	{
+		return m_templates.size();
+	}
+
+	//
+	// Match the string against the patterns, the latest matching pattern wins
+	// like it would for an expanded entry
+	//
+	bool Find(const std::u16string_view& str, std::u16string& result) const
+	{
+		if (str.empty() || m_templates.empty())
+			return false;
+
+		// Patterns are indexed by the first and last unit of their outer literals,
+		// an empty literal is indexed as 0 and matches every string
+		const uint32_t keys[] = {
+			indexKey(str.substr(0, 1), str.substr(str.size() - 1)),
+			indexKey(str.substr(0, 1), {}),
+			indexKey({}, str.substr(str.size() - 1)),
+			indexKey({}, {})
+		};
+
+		const Template* pBest = nullptr;
+		std::u16string_view bestKey;
+		std::u16string_view bestValue;
+
+		for (const uint32_t& indexKey : keys)
+		{
+			const auto it = m_index.find(indexKey);
+			if (it == m_index.end())
+				continue;
+
+			for (const uint32_t& idx : it->second)
+			{
+				const Template& tmpl = m_templates[idx];
+				if (pBest != nullptr && &tmpl < pBest)
+					continue;
+
+				std::u16string_view key;
+				std::u16string_view value;
+				if (match(tmpl, str, key, value))
+				{
+					pBest     = &tmpl;
+					bestKey   = key;
+					bestValue = value;
+				}
+			}
+		}
+
+		if (pBest == nullptr)
+			return false;
+
+		formatPattern(pBest->translated, bestKey, bestValue, result);
+		return true;
+	}
+
+private:
+	static uint32_t indexKey(const std::u16string_view& prefix, const std::u16string_view& suffix)
+	{
+		const uint32_t first = prefix.empty() ? 0 : prefix.front();
+		const uint32_t last  = suffix.empty() ? 0 : suffix.back();
+		return (first << 16) | last;
+	}
+
+	static bool startsWith(const std::u16string_view& str, const std::u16string_view& prefix)
+	{
+		return str.size() >= prefix.size() && str.compare(0, prefix.size(), prefix) == 0;
+	}
+
+	static bool endsWith(const std::u16string_view& str, const std::u16string_view& suffix)
+	{
+		return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+
+	bool resolve(const Template& tmpl, const std::u16string_view& capture, std::u16string_view& key, std::u16string_view& value) const
+	{
+		const Group& group = m_groups[tmpl.group];
+
+		if (tmpl.original.arguments.front() == 0)
+		{
+			const auto it = group.values.find(capture);
+			if (it == group.values.end())
+				return false;
+
+			key   = it->first;
+			value = it->second;
+		}
+		else
+		{
+			const auto it = group.keys.find(capture);
+			if (it == group.keys.end())
+				return false;
+
+			key   = it->second;
+			value = it->first;
+		}
+
+		return true;
+	}
+
+	bool match(const Template& tmpl, const std::u16string_view& str, std::u16string_view& key, std::u16string_view& value) const
+	{
+		const CompiledPattern& pattern = tmpl.original;
+		const std::u16string& prefix   = pattern.literals.front();
+		const std::u16string& suffix   = pattern.literals.back();
+
+		// Patterns without placeholders only match themselves
+		if (pattern.arguments.empty())
+		{
+			key   = {};
+			value = {};
+			return str == prefix;
+		}
+
+		if (str.size() < prefix.size() + suffix.size() || !startsWith(str, prefix) || !endsWith(str, suffix))
+			return false;
+
+		const std::size_t begin = prefix.size();
+		const std::size_t end   = str.size() - suffix.size();
+
+		// A single placeholder covers everything between the outer literals
+		if (pattern.arguments.size() == 1)
+			return resolve(tmpl, str.substr(begin, end - begin), key, value);
+
+		// Otherwise the first placeholder ends where the next literal starts, try every
+		// occurrence and verify the candidate against the rest of the string
+		const std::u16string& next = pattern.literals[1];
+
+		for (std::size_t pos = str.find(next, begin); pos != std::u16string_view::npos && pos <= end; pos = str.find(next, pos + 1))
+		{
+			if (resolve(tmpl, str.substr(begin, pos - begin), key, value) && matchesFormatted(pattern, str, key, value))
+				return true;
+		}
+
+		return false;
+	}
+
+	// Equal to comparing the string with formatPattern(pattern, key, value), segment by segment
+	static bool matchesFormatted(const CompiledPattern& pattern, std::u16string_view str, const std::u16string_view& key, const std::u16string_view& value)
+	{
+		for (std::size_t i = 0; i < pattern.arguments.size(); i++)
+		{
+			const std::u16string_view& argument = pattern.arguments[i] == 0 ? key : value;
+			if (!startsWith(str, pattern.literals[i]))
+				return false;
+
+			str.remove_prefix(pattern.literals[i].size());
+			if (!startsWith(str, argument))
+				return false;
+
+			str.remove_prefix(argument.size());
+		}
+
+		return str == pattern.literals.back();
+	}
+
+private:
+	std::vector<Group> m_groups;
+	std::vector<Template> m_templates;
+	std::unordered_map<uint32_t, std::vector<uint32_t>> m_index;
+};
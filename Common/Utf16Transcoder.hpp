@@ -0,0 +1,159 @@
+/*
+ *  File: Utf16Transcoder.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "AsciiRun.hpp"
+#include "ScratchBuffer.hpp"
+#include "Utf8.hpp"
+
+//
+// Converts between UTF-16 and UTF-8 like WideCharToMultiByte and MultiByteToWideChar
+// with CP_UTF8, but portable and without asking for the size first. Unpaired
+// surrogates and invalid UTF-8 become U+FFFD.
+//
+class Utf16Transcoder
+{
+public:
+	static constexpr char16_t REPLACEMENT_CHAR = 0xFFFD;
+
+	// A surrogate pair becomes 4 bytes, every other character at most 3
+	static constexpr std::size_t MaxUtf8Size(const std::size_t& utf16Size)
+	{
+		return utf16Size * 3;
+	}
+
+	// No character takes more UTF-16 units than UTF-8 bytes
+	static constexpr std::size_t MaxUtf16Size(const std::size_t& utf8Size)
+	{
+		return utf8Size;
+	}
+
+	//
+	// Convert the UTF-16 characters to UTF-8. The buffer needs room for MaxUtf8Size() bytes,
+	// returns the number of bytes written, no null terminator is added.
+	//
+	static std::size_t ToUtf8(const char16_t* pSrc, const std::size_t& size, char* pDst)
+	{
+		char* pOut = pDst;
+
+		for (std::size_t i = 0; i < size;)
+		{
+			uint32_t c = pSrc[i];
+
+			if (c < 0x80)
+			{
+				const std::size_t count = AsciiRun::Narrow(pSrc + i, size - i, pOut);
+				pOut += count;
+				i += count;
+				continue;
+			}
+
+			i++;
+
+			if (c >= 0xD800 && c <= 0xDFFF)
+			{
+				if (c <= 0xDBFF && i < size && pSrc[i] >= 0xDC00 && pSrc[i] <= 0xDFFF)
+					c = 0x10000 + ((c - 0xD800) << 10) + (pSrc[i++] - 0xDC00);
+				else
+					c = REPLACEMENT_CHAR;
+			}
+
+			Utf8::Write(c, pOut);
+		}
+
+		return static_cast<std::size_t>(pOut - pDst);
+	}
+
+	//
+	// Convert the UTF-8 bytes to UTF-16. The buffer needs room for MaxUtf16Size() characters,
+	// returns the number of characters written, no null terminator is added.
+	//
+	static std::size_t FromUtf8(const char* pSrc, const std::size_t& size, char16_t* pDst)
+	{
+		const uint8_t* pIn = reinterpret_cast<const uint8_t*>(pSrc);
+		char16_t* pOut     = pDst;
+
+		for (std::size_t i = 0; i < size;)
+		{
+			if (pIn[i] < 0x80)
+			{
+				const std::size_t count = AsciiRun::Widen(pSrc + i, size - i, pOut);
+				pOut += count;
+				i += count;
+				continue;
+			}
+
+			uint32_t c = 0;
+			i += Utf8::Read(pIn + i, size - i, c);
+
+			if (c == 0)
+				*pOut++ = REPLACEMENT_CHAR;
+			else if (c < 0x10000)
+				*pOut++ = static_cast<char16_t>(c);
+			else
+			{
+				c -= 0x10000;
+				*pOut++ = static_cast<char16_t>(0xD800 + (c >> 10));
+				*pOut++ = static_cast<char16_t>(0xDC00 + (c & 0x3FF));
+			}
+		}
+
+		return static_cast<std::size_t>(pOut - pDst);
+	}
+
+	// Convert into the buffer, the null terminated result is valid until the buffer is used again
+	static std::string_view ToUtf8(const std::u16string_view& utf16, ScratchBuffer<char>& buffer)
+	{
+		char* pDst = buffer.Reserve(MaxUtf8Size(utf16.size()));
+		return buffer.Finish(ToUtf8(utf16.data(), utf16.size(), pDst));
+	}
+
+	static std::u16string_view FromUtf8(const std::string_view& utf8, ScratchBuffer<char16_t>& buffer)
+	{
+		char16_t* pDst = buffer.Reserve(MaxUtf16Size(utf8.size()));
+		return buffer.Finish(FromUtf8(utf8.data(), utf8.size(), pDst));
+	}
+
+	static std::string ToUtf8(const std::u16string_view& utf16)
+	{
+		std::string utf8(MaxUtf8Size(utf16.size()), '\0');
+		utf8.resize(ToUtf8(utf16.data(), utf16.size(), utf8.data()));
+		return utf8;
+	}
+
+	static std::u16string FromUtf8(const std::string_view& utf8)
+	{
+		std::u16string utf16(MaxUtf16Size(utf8.size()), u'\0');
+		utf16.resize(FromUtf8(utf8.data(), utf8.size(), utf16.data()));
+		return utf16;
+	}
+};
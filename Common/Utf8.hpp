@@ -0,0 +1,111 @@
+/*
+ *  File: Utf8.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//
+// Reading and writing of single UTF-8 sequences, shared by the transcoders.
+// Broken input is handled like MultiByteToWideChar handles it.
+//
+struct Utf8
+{
+	//
+	// Read the sequence at a non-ASCII byte and return its length. Invalid sequences give
+	// a character of 0 and the length of their longest valid start, but at least 1, so
+	// every broken part is replaced once.
+	//
+	static std::size_t Read(const uint8_t* pIn, const std::size_t& size, uint32_t& c)
+	{
+		const uint8_t lead = pIn[0];
+		std::size_t length = 0;
+		uint8_t min        = 0x80;
+		uint8_t max        = 0xBF;
+
+		if (lead >= 0xC2 && lead <= 0xDF)
+			length = 2, c = lead & 0x1F;
+		else if (lead >= 0xE0 && lead <= 0xEF)
+			length = 3, c = lead & 0x0F;
+		else if (lead >= 0xF0 && lead <= 0xF4)
+			length = 4, c = lead & 0x07;
+		else
+		{
+			c = 0;
+			return 1;
+		}
+
+		// Overlong forms, surrogates and characters above U+10FFFF are rejected with the second byte
+		if (lead == 0xE0)
+			min = 0xA0;
+		else if (lead == 0xED)
+			max = 0x9F;
+		else if (lead == 0xF0)
+			min = 0x90;
+		else if (lead == 0xF4)
+			max = 0x8F;
+
+		for (std::size_t i = 1; i < length; i++)
+		{
+			if (i >= size || pIn[i] < min || pIn[i] > max)
+			{
+				c = 0;
+				return i;
+			}
+
+			c   = (c << 6) | (pIn[i] & 0x3F);
+			min = 0x80;
+			max = 0xBF;
+		}
+
+		return length;
+	}
+
+	static void Write(const uint32_t& c, char*& pOut)
+	{
+		if (c < 0x80)
+			*pOut++ = static_cast<char>(c);
+		else if (c < 0x800)
+		{
+			*pOut++ = static_cast<char>(0xC0 | (c >> 6));
+			*pOut++ = static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else if (c < 0x10000)
+		{
+			*pOut++ = static_cast<char>(0xE0 | (c >> 12));
+			*pOut++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			*pOut++ = static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else
+		{
+			*pOut++ = static_cast<char>(0xF0 | (c >> 18));
+			*pOut++ = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+			*pOut++ = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			*pOut++ = static_cast<char>(0x80 | (c & 0x3F));
+		}
+	}
+};
@@ -104,24 +104,10 @@ BOOL ProcessAttach(HMODULE hDll)
 	SyelogOpen("demon" DETOURS_STRINGIFY(DETOURS_BITS), SYELOG_FACILITY_APPLICATION);
 	Syelog(SYELOG_SEVERITY_INFORMATION, "##################################################################\n");
 	Syelog(SYELOG_SEVERITY_INFORMATION, "### %ls\n", wzExeName);
-
-	Syelog(SYELOG_SEVERITY_INFORMATION, "### Loading translations...\n");
 #endif
 
-	try
-	{
-		TranslationManager::LoadTranslations();
-#if INCLUDE_DEBUG_LOGGING
-		Syelog(SYELOG_SEVERITY_INFORMATION, "### Loaded %d translations.\n", TranslationManager::GetTranslationCount());
-#endif
-	}
-	catch ([[maybe_unused]] const std::exception& e)
-	{
-#if INCLUDE_DEBUG_LOGGING
-		Syelog(SYELOG_SEVERITY_FATAL, "### Error loading translations: %s\n", e.what());
-#endif
-		MessageBox(NULL, L"Failed to load the interface translation. Please make sure the corresponding JSON file is present and valid. Parts of the interface will not be translated.", L"Demonion 2 Redirect", MB_OK | MB_ICONERROR);
-	}
+	// The translations are loaded on a worker thread, the hooks pass every string through until they are ready
+	TranslationManager::StartLoading();
 
 	RedirectManager::SetupAllDetours();
 
@@ -143,6 +129,8 @@ BOOL ProcessAttach(HMODULE hDll)
 
 BOOL ProcessDetach(HMODULE hDll)
 {
+	TranslationManager::StopWatching();
+
 	ThreadDetach(hDll);
 
 	logging::SetBLog(FALSE);
@@ -153,12 +141,19 @@ BOOL ProcessDetach(HMODULE hDll)
 	if (error != NO_ERROR)
 		Syelog(SYELOG_SEVERITY_FATAL, "### Error detaching detours: %d\n", error);
 
+	const BundleLookupStats stats = TranslationManager::GetLookupStats();
+	Syelog(SYELOG_SEVERITY_INFORMATION, "### Lookups: %llu, hits: %llu, filter skips: %llu, false positives: %llu (%.2f%%)\n", stats.lookups, stats.hits, stats.filterSkips, stats.falsePositives, stats.GetFalsePositiveRate() * 100.0);
+
 	Syelog(SYELOG_SEVERITY_NOTICE, "### Closing.\n");
 	SyelogClose(FALSE);
 
 	logging::Cleanup();
 #endif
 
+	// Once the hooks are gone all translations can be freed in one go
+	if (error == NO_ERROR)
+		TranslationManager::ReleaseTranslations();
+
 	return TRUE;
 }
 
@@ -2,10 +2,13 @@
 
 #include "Logging.hpp"
 
+#include "../Common/ModuleUtils.hpp"
+
 #include <detours.h>
 
-DetourEntry::DetourEntry(const std::vector<BYTE>& searchPattern, PVOID* ppRealFunc, PVOID pMineFunc, const std::string& name) :
+DetourEntry::DetourEntry(const SignaturePattern& searchPattern, PVOID* ppRealFunc, PVOID pMineFunc, const std::string& name, const std::string& section) :
 	m_searchPattern(searchPattern),
+	m_section(section),
 	m_ppRealFunc(ppRealFunc),
 	m_pMineFunc(pMineFunc),
 	m_name(name)
@@ -20,21 +23,41 @@ DetourEntry::DetourEntry(const intptr_t& rva, PVOID* ppRealFunc, PVOID pMineFunc
 {
 }
 
-void DetourEntry::Setup()
+void DetourEntry::SetupAll(std::vector<DetourEntry>& entries, const std::size_t& threadCount)
+{
+	ImageScanner scanner(getModuleImage(), threadCount);
+	std::vector<std::size_t> patternIndices(entries.size(), SignatureScanner::NOT_FOUND);
+
+	for (std::size_t i = 0; i < entries.size(); i++)
+	{
+		if (entries[i].m_rva == -1 && !entries[i].m_searchPattern.Empty())
+			patternIndices[i] = scanner.Add(entries[i].m_searchPattern, entries[i].m_section);
+	}
+
+	// Functions that are not found get the address ~0, which is -1 as an intptr_t
+	const std::vector<uintptr_t> patternVAs = findFunctions(scanner);
+
+#if INCLUDE_DEBUG_LOGGING
+	Syelog(SYELOG_SEVERITY_INFORMATION, "### Took %zu of %zu functions from the address cache, scanned %zu bytes\n", scanner.GetCachedCount(), scanner.Size(), scanner.GetScannedBytes());
+#endif
+
+	for (std::size_t i = 0; i < entries.size(); i++)
+		entries[i].setup(patternIndices[i] != SignatureScanner::NOT_FOUND ? static_cast<intptr_t>(patternVAs[patternIndices[i]]) : -1);
+}
+
+void DetourEntry::setup(const intptr_t& patternVA)
 {
-	calcVA();
+	calcVA(patternVA);
 	if (m_va != -1)
 		*m_ppRealFunc = reinterpret_cast<PVOID>(m_va);
 }
 
-void DetourEntry::calcVA()
+void DetourEntry::calcVA(const intptr_t& patternVA)
 {
 	if (m_rva != -1)
 		m_va = calcFunctionAddress(m_rva);
-	else if (!m_searchPattern.empty())
-		m_va = findFunction(m_searchPattern);
 	else
-		m_va = -1;
+		m_va = patternVA;
 
 	if (m_va == -1)
 	{
@@ -101,38 +124,6 @@ bool DetourEntry::detach() const
 	return true;
 }
 
-intptr_t DetourEntry::findFunction(const std::vector<BYTE>& tarBytes)
-{
-	const intptr_t startAddress = reinterpret_cast<intptr_t>(GetModuleHandleW(nullptr));
-	MEMORY_BASIC_INFORMATION info;
-	intptr_t endAddress = startAddress;
-
-	do
-	{
-		VirtualQuery(reinterpret_cast<void*>(endAddress), &info, sizeof(info));
-		endAddress = reinterpret_cast<intptr_t>(info.BaseAddress) + info.RegionSize;
-	} while (info.Protect > PAGE_NOACCESS);
-
-	endAddress -= info.RegionSize;
-
-	const std::size_t procMemLength = static_cast<std::size_t>(endAddress - startAddress);
-	const std::size_t tarLength     = tarBytes.size();
-	const BYTE* pProcData           = reinterpret_cast<BYTE*>(startAddress);
-
-	for (std::size_t i = 0; i < procMemLength - tarLength; i++)
-	{
-		for (std::size_t j = 0; j <= tarLength; j++)
-		{
-			if (j == tarLength)
-				return startAddress + i;
-			else if (pProcData[i + j] != tarBytes[j])
-				break;
-		}
-	}
-
-	return -1;
-}
-
 intptr_t DetourEntry::calcFunctionAddress(const intptr_t& funcOffset)
 {
 	const intptr_t baseAddress = reinterpret_cast<intptr_t>(GetModuleHandleW(nullptr));
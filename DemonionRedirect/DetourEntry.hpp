@@ -4,12 +4,23 @@
 #include <vector>
 #include <windows.h>
 
+#include "../Common/ImageScanner.hpp"
+
 class DetourEntry
 {
 public:
-	DetourEntry(const std::vector<BYTE>& searchPattern, PVOID* ppRealFunc, PVOID pMineFunc, const std::string& name = "");
+	//
+	// An empty section name searches all executable sections. The pattern may match near a call
+	// site and lead to the function with its steps, e.g. Parse("E8 ?? ?? ?? ?? 84 C0").FollowRelative(1).
+	//
+	DetourEntry(const SignaturePattern& searchPattern, PVOID* ppRealFunc, PVOID pMineFunc, const std::string& name = "", const std::string& section = "");
 	DetourEntry(const intptr_t& rva, PVOID* ppRealFunc, PVOID pMineFunc, const std::string& name = "");
-	void Setup();
+
+	//
+	// Determine the addresses of all entries, the search patterns are found in a single pass over the image.
+	// Large images can be scanned on several threads, but not from inside DllMain.
+	//
+	static void SetupAll(std::vector<DetourEntry>& entries, const std::size_t& threadCount = 1);
 
 	bool Attach() const
 	{
@@ -37,17 +48,18 @@ public:
 	}
 
 private:
-	void calcVA();
+	void setup(const intptr_t& patternVA);
+	void calcVA(const intptr_t& patternVA);
 
 	bool attach() const;
 
 	bool detach() const;
 
-	static intptr_t findFunction(const std::vector<BYTE>& tarBytes);
 	static intptr_t calcFunctionAddress(const intptr_t& funcOffset);
 
 private:
-	std::vector<BYTE> m_searchPattern = {};
+	SignaturePattern m_searchPattern = {};
+	std::string m_section            = "";
 
 	intptr_t m_rva = -1;
 	intptr_t m_va  = -1;
@@ -18,8 +18,7 @@ public:
 
 	static void SetupAllDetours()
 	{
-		for (DetourEntry& detour : GetInstance().m_detours)
-			detour.Setup();
+		DetourEntry::SetupAll(GetInstance().m_detours);
 	}
 
 	static void AttachAllDetours()
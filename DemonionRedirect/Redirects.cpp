@@ -1,6 +1,7 @@
 #include "Redirects.hpp"
 
 #include <cstdint>
+#include <cwchar>
 #include <windows.h>
 
 #include "Logging.hpp"
@@ -8,6 +9,8 @@
 #include "TranslationManager.hpp"
 #include "Utils.hpp"
 
+#include "../Common/ScratchBuffer.hpp"
+
 #define ADD_REDIRECT(PATTERN_OR_RVA, FUNC_NAME) \
 	RedirectManager::AddDetour(DetourEntry(PATTERN_OR_RVA, (PVOID*)&Real_##FUNC_NAME, (PVOID)Mine_##FUNC_NAME, #FUNC_NAME))
 
@@ -29,87 +32,119 @@ extern "C"
 
 DWORD* __fastcall Mine_ExeStringFunc1(DWORD* a1, int32_t a2, BYTE* pSource, uint32_t a4)
 {
-	std::wstring unicodeStr = reinterpret_cast<const wchar_t*>(pSource);
-	std::wstring trStr      = TranslationManager::GetTranslationW(unicodeStr);
+	const TranslationManager::ReadGuard translations = TranslationManager::Read();
+	std::size_t length    = 0;
+	const wchar_t* pTrStr = TranslationManager::GetTranslationW(translations, reinterpret_cast<const wchar_t*>(pSource), length);
 
-	if (trStr == L"")
+	if (pTrStr == nullptr)
 		return Real_ExeStringFunc1(a1, a2, pSource, a4);
 
 #if INCLUDE_DEBUG_LOGGING
-	_Print("[ExeStringFunc1]: %ls\n", trStr.c_str());
+	_Print("[ExeStringFunc1]: %ls\n", pTrStr);
 #endif
 
-	return Real_ExeStringFunc1(a1, a2, reinterpret_cast<BYTE*>(const_cast<wchar_t*>(trStr.c_str())), trStr.size());
+	return Real_ExeStringFunc1(a1, a2, reinterpret_cast<BYTE*>(const_cast<wchar_t*>(pTrStr)), static_cast<uint32_t>(length));
 }
 
 DWORD* __fastcall Mine_ExeStringFunc2(DWORD* a1, int32_t a2, BYTE* pSource, uint32_t a4)
 {
-	std::wstring unicodeStr = reinterpret_cast<const wchar_t*>(pSource);
-	std::wstring trStr      = TranslationManager::GetTranslationW(unicodeStr);
+	const TranslationManager::ReadGuard translations = TranslationManager::Read();
+	std::size_t length    = 0;
+	const wchar_t* pTrStr = TranslationManager::GetTranslationW(translations, reinterpret_cast<const wchar_t*>(pSource), length);
 
-	if (trStr == L"")
+	if (pTrStr == nullptr)
 		return Real_ExeStringFunc2(a1, a2, pSource, a4);
 
 #if INCLUDE_DEBUG_LOGGING
-	_Print("[ExeStringFunc2]: %ls\n", trStr.c_str());
+	_Print("[ExeStringFunc2]: %ls\n", pTrStr);
 #endif
 
-	return Real_ExeStringFunc2(a1, a2, reinterpret_cast<BYTE*>(const_cast<wchar_t*>(trStr.c_str())), trStr.size());
+	return Real_ExeStringFunc2(a1, a2, reinterpret_cast<BYTE*>(const_cast<wchar_t*>(pTrStr)), static_cast<uint32_t>(length));
 }
 
 int* __cdecl Mine_ExeStringFunc3(int* a1, int a2, WORD* a3, int* a4, int a5, int a6, int a7, int a8, int a9)
 {
-	std::wstring unicodeStr = reinterpret_cast<const wchar_t*>(a3);
-	std::wstring trStr      = TranslationManager::GetTranslationW(unicodeStr);
+	const TranslationManager::ReadGuard translations = TranslationManager::Read();
+	std::size_t length    = 0;
+	const wchar_t* pTrStr = TranslationManager::GetTranslationW(translations, reinterpret_cast<const wchar_t*>(a3), length);
 
-	if (trStr == L"")
+	if (pTrStr == nullptr)
 		return Real_ExeStringFunc3(a1, a2, a3, a4, a5, a6, a7, a8, a9);
 
 #if INCLUDE_DEBUG_LOGGING
-	_Print("[ExeStringFunc3]: %ls\n", trStr.c_str());
+	_Print("[ExeStringFunc3]: %ls\n", pTrStr);
 #endif
 
-	return Real_ExeStringFunc3(a1, a2, reinterpret_cast<WORD*>(const_cast<wchar_t*>(trStr.c_str())), a4, a5, a6, a7, a8, a9);
+	return Real_ExeStringFunc3(a1, a2, reinterpret_cast<WORD*>(const_cast<wchar_t*>(pTrStr)), a4, a5, a6, a7, a8, a9);
 }
 
 void __cdecl Mine_ExeStringFunc4(int a1, WORD* a2, float a3, float a4, float* a5, int a6, int a7, int a8, int a9, int16_t a10)
 {
-	std::wstring unicodeStr = reinterpret_cast<const wchar_t*>(a2);
-	std::wstring trStr      = TranslationManager::GetTranslationW(unicodeStr);
-	if (trStr == L"")
+	const TranslationManager::ReadGuard translations = TranslationManager::Read();
+	std::size_t length    = 0;
+	const wchar_t* pTrStr = TranslationManager::GetTranslationW(translations, reinterpret_cast<const wchar_t*>(a2), length);
+	if (pTrStr == nullptr)
 	{
 		Real_ExeStringFunc4(a1, a2, a3, a4, a5, a6, a7, a8, a9, a10);
 		return;
 	}
 
 #if INCLUDE_DEBUG_LOGGING
-	_Print("[ExeStringFunc4]: %ls\n", trStr.c_str());
+	_Print("[ExeStringFunc4]: %ls\n", pTrStr);
 #endif
 
-	Real_ExeStringFunc4(a1, reinterpret_cast<WORD*>(const_cast<wchar_t*>(trStr.c_str())), a3, a4, a5, a6, a7, a8, a9, a10);
+	Real_ExeStringFunc4(a1, reinterpret_cast<WORD*>(const_cast<wchar_t*>(pTrStr)), a3, a4, a5, a6, a7, a8, a9, a10);
 }
 
 int WINAPI Mine_FormatStringFunc(int a1, wchar_t* Format, ...)
 {
-	const std::size_t BUFFER_SIZE = 4096;
-	wchar_t buffer[BUFFER_SIZE];
-	std::wstring fmtStr = Format;
-	std::wstring trStr  = TranslationManager::GetTranslationW(fmtStr);
-
-	if (trStr != L"")
-	{
-		fmtStr = trStr;
+	// Every thread formats into a buffer of its own that only grows, so formatting does not allocate
+	thread_local ScratchBuffer<wchar_t> buffer;
+	const TranslationManager::ReadGuard translations = TranslationManager::Read();
+	std::size_t length      = 0;
+	const wchar_t* pTrStr   = TranslationManager::GetTranslationW(translations, Format, length, true);
+	const wchar_t* pFormat  = pTrStr != nullptr ? pTrStr : Format;
+	const bool isTranslated = pTrStr != nullptr;
 
 #if INCLUDE_DEBUG_LOGGING
-		_Print("[FormatStringFunc]: %ls\n", fmtStr.c_str());
+	if (isTranslated)
+		_Print("[FormatStringFunc]: %ls\n", pTrStr);
 #endif
+
+	// Translations are only checked to read the same arguments as their original if it has a
+	// conversion, otherwise the translated text is taken as is instead of as a format
+	if (isTranslated && std::wcschr(Format, L'%') == nullptr)
+	{
+		wchar_t* pText = buffer.Reserve(length);
+		std::wmemcpy(pText, pTrStr, length);
+		buffer.Finish(length);
+
+		return Real_FormatStringFunc(a1, pText);
 	}
 
 	va_list args;
 	va_start(args, Format);
-	_vsnwprintf_s(buffer, BUFFER_SIZE, fmtStr.c_str(), args);
+
+	// Translated templates may reorder the arguments, e.g. "%2$s %1$d", which requires the positional printf variants
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	const int textLength = isTranslated ? _vscwprintf_p(pFormat, argsCopy) : _vscwprintf(pFormat, argsCopy);
+	va_end(argsCopy);
+
+	// Texts longer than any before only grow the buffer instead of being cut off, a broken format gives an empty text
+	wchar_t* pText = buffer.Reserve(textLength < 0 ? 0 : static_cast<std::size_t>(textLength));
+	pText[0]       = L'\0';
+
+	if (textLength >= 0)
+	{
+		if (isTranslated)
+			_vswprintf_p(pText, static_cast<std::size_t>(textLength) + 1, pFormat, args);
+		else
+			_vsnwprintf_s(pText, static_cast<std::size_t>(textLength) + 1, _TRUNCATE, pFormat, args);
+	}
+
 	va_end(args);
-	int result = Real_FormatStringFunc(a1, buffer);
+	int result = Real_FormatStringFunc(a1, pText);
 	return result;
 }
 
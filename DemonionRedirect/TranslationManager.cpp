@@ -1,92 +1,157 @@
 #include "TranslationManager.hpp"
+#include "Logging.hpp"
 #include "Utils.hpp"
 
-#include <format>
 #include <fstream>
+#include <stdexcept>
 
-std::wstring TranslationManager::GetTranslationW(const std::wstring& key)
-{
-	const std::string utf8Key = unicode2utf8(key);
-	const std::string trStr   = GetInstance().getTranslation(utf8Key);
-	return utf82unicode(trStr);
-}
+#include "../Common/TranslationCompiler.hpp"
+#include "../Common/TranslationLookup.hpp"
 
-std::string TranslationManager::getTranslation(const std::string& key)
+const wchar_t* TranslationManager::GetTranslationW(const ReadGuard& translations, const std::wstring_view& key, std::size_t& length, const bool& asFormat)
 {
-	if (m_translations.contains(key))
-		return m_translations[key].get<std::string>();
+	const Snapshot* pSnapshot = translations.Get();
+	if (pSnapshot == nullptr)
+		return nullptr;
 
-	return "";
+	const std::u16string_view wideKey(reinterpret_cast<const char16_t*>(key.data()), key.size());
+	return reinterpret_cast<const wchar_t*>(lookupTranslation(pSnapshot->translations, pSnapshot->templates, pSnapshot->patternResults, wideKey, length, asFormat));
 }
 
-void TranslationManager::postProcessTranslations(nlohmann::json& translations)
+void TranslationManager::loadTranslation(const std::filesystem::path& translationFilePath, TranslationBundleBuilder& builder) const
 {
-	if (!translations.contains("patterns") || !translations.contains("data"))
+	if (!std::filesystem::exists(translationFilePath))
 		return;
 
-	nlohmann::json newData = {};
+	std::ifstream fs(translationFilePath);
+	if (!fs.is_open())
+		return;
 
-	nlohmann::json& patterns = translations["patterns"];
-	nlohmann::json& data     = translations["data"];
+	TranslationEncoders encoders;
+	encoders.toWide = [](const std::string& utf8) { return Utf16Transcoder::FromUtf8(utf8); };
 
-	for (auto& [key, value] : data.items())
+	// Files with broken JSON are skipped, like before the translations were streamed
+	try
 	{
-		std::string valueStr = value.get<std::string>();
-		for (auto& [pK, pV] : patterns.items())
-		{
-			std::string pVStr = pV.get<std::string>();
-
-			std::string k = std::vformat(pK, std::make_format_args(key, valueStr));
-			std::string v = std::vformat(pVStr, std::make_format_args(key, valueStr));
+		[[maybe_unused]] const std::vector<std::string> textOnlyKeys = compileRedirectTranslations(fs, builder, encoders);
 
-			newData[k] = v;
-		}
+#if INCLUDE_DEBUG_LOGGING
+		for (const std::string& key : textOnlyKeys)
+			Syelog(SYELOG_SEVERITY_WARNING, "### Warning: The translation of %s is not used as a format, its conversions do not match the original\n", key.c_str());
+#endif
+	}
+	catch (const TranslationParseError&)
+	{
+		return;
 	}
-
-	translations = newData;
 }
 
-nlohmann::json TranslationManager::loadTranslation(const std::filesystem::path& translationFilePath)
+void TranslationManager::startLoading(const std::filesystem::path& translationFilePath)
 {
-	nlohmann::json translations;
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
 
-	if (!std::filesystem::exists(translationFilePath))
-		return translations;
+	// The watcher thread runs code of this module until the process exits, so it must never be unloaded
+	HMODULE hPinned = NULL;
+	GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_PIN, reinterpret_cast<LPCWSTR>(&GetInstance), &hPinned);
 
-	std::ifstream fs(translationFilePath);
-	if (!fs.is_open())
-		return translations;
+	// Called from DllMain, the worker only starts running once the loader lock was released
+	m_snapshots.Start(
+		{ translationFilePath, getBundlePath(translationFilePath) },
+		[this, translationFilePath]() { return reloadSnapshot(translationFilePath); },
+		[this, translationFilePath, startTime]() { return loadInitialSnapshot(translationFilePath, startTime); });
+}
+
+std::unique_ptr<TranslationManager::Snapshot> TranslationManager::loadInitialSnapshot(const std::filesystem::path& translationFilePath, [[maybe_unused]] const std::chrono::steady_clock::time_point& startTime) const
+{
+#if INCLUDE_DEBUG_LOGGING
+	Syelog(SYELOG_SEVERITY_INFORMATION, "### Loading translations...\n");
+#endif
 
 	try
 	{
-		fs >> translations;
+		std::unique_ptr<Snapshot> pSnapshot = loadSnapshot(translationFilePath);
+
+#if INCLUDE_DEBUG_LOGGING
+		const long long readyTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+		Syelog(SYELOG_SEVERITY_INFORMATION, "### Loaded %d translations and %d patterns, ready %lld ms after attaching.\n", pSnapshot->translations.Size(), pSnapshot->templates.Size(), readyTime);
+#endif
+
+		return pSnapshot;
 	}
-	catch (const nlohmann::json::parse_error&)
+	catch ([[maybe_unused]] const std::exception& e)
 	{
+#if INCLUDE_DEBUG_LOGGING
+		Syelog(SYELOG_SEVERITY_FATAL, "### Error loading translations: %s\n", e.what());
+#endif
+		// Shown from the worker thread, showing it inside DllMain would block the game from starting
+		MessageBox(NULL, L"Failed to load the interface translation. Please make sure the corresponding JSON file is present and valid. Parts of the interface will not be translated.", L"Demonion 2 Redirect", MB_OK | MB_ICONERROR);
+		return nullptr;
 	}
+}
 
-	postProcessTranslations(translations);
-
-	return translations;
+std::unique_ptr<TranslationManager::Snapshot> TranslationManager::reloadSnapshot(const std::filesystem::path& translationFilePath) const
+{
+	try
+	{
+		std::unique_ptr<Snapshot> pSnapshot = loadSnapshot(translationFilePath);
+#if INCLUDE_DEBUG_LOGGING
+		Syelog(SYELOG_SEVERITY_INFORMATION, "### Reloaded %d translations and %d patterns.\n", pSnapshot->translations.Size(), pSnapshot->templates.Size());
+#endif
+		return pSnapshot;
+	}
+	catch ([[maybe_unused]] const std::exception& e)
+	{
+#if INCLUDE_DEBUG_LOGGING
+		Syelog(SYELOG_SEVERITY_WARNING, "### Warning: Reloading the translations failed: %s\n", e.what());
+#endif
+		return nullptr;
+	}
 }
 
-void TranslationManager::loadTranslations(const std::filesystem::path& translationFilePath)
+std::unique_ptr<TranslationManager::Snapshot> TranslationManager::loadSnapshot(const std::filesystem::path& translationFilePath) const
 {
-	m_translations.clear();
-	if (!std::filesystem::exists(translationFilePath))
-		return;
+	std::unique_ptr<Snapshot> pSnapshot = std::make_unique<Snapshot>();
 
-	if (std::filesystem::is_directory(translationFilePath))
+	std::vector<std::filesystem::path> files;
+	if (std::filesystem::exists(translationFilePath))
 	{
-		for (const auto& tlFile : std::filesystem::directory_iterator(translationFilePath))
-		{
-			if (tlFile.is_regular_file() && tlFile.path().extension() == ".json")
-			{
-				nlohmann::json fileTranslations = loadTranslation(tlFile.path());
-				m_translations.update(fileTranslations);
-			}
-		}
+		files = collectTranslationFiles(translationFilePath);
+		std::erase_if(files, [](const std::filesystem::path& file) { return file.extension() != ".json"; });
 	}
-	else if (translationFilePath.extension() == ".json")
-		m_translations = loadTranslation(translationFilePath);
+
+	// A packed bundle next to the translations is mapped and used in place, unless a JSON file was edited after packing
+	if (isBundleCurrent(getBundlePath(translationFilePath), files) && pSnapshot->translations.Open(getBundlePath(translationFilePath)))
+	{
+		if (pSnapshot->translations.GetKeyEncoding() == BundleKeyEncoding::UTF16 && pSnapshot->templates.Attach(pSnapshot->translations))
+			return pSnapshot;
+
+#if INCLUDE_DEBUG_LOGGING
+		Syelog(SYELOG_SEVERITY_WARNING, "### Warning: %ls is not UTF-16 keyed or has invalid patterns, ignoring it\n", getBundlePath(translationFilePath).c_str());
+#endif
+		pSnapshot->translations.Clear();
+	}
+
+	if (files.empty())
+		return pSnapshot;
+
+	const auto compileFile = [this](const std::filesystem::path& file, TranslationBundleBuilder& fileBuilder) { loadTranslation(file, fileBuilder); };
+
+	TranslationBundleBuilder builder(BundleKeyEncoding::UTF16);
+	compileTranslationFiles(files, builder, compileFile);
+
+	if (!pSnapshot->translations.Load(builder.Build()))
+		throw std::runtime_error("Failed to build the translation bundle");
+
+	// The patterns were checked while compiling, so this only fails if the bundle is broken
+	if (!pSnapshot->templates.Attach(pSnapshot->translations))
+		throw std::runtime_error("Failed to compile the translation patterns");
+
+	return pSnapshot;
+}
+
+std::filesystem::path TranslationManager::getBundlePath(const std::filesystem::path& translationFilePath)
+{
+	std::filesystem::path bundlePath = translationFilePath;
+	bundlePath.replace_extension(".bin");
+	return bundlePath;
 }
@@ -1,44 +1,102 @@
 #pragma once
 
+#include <chrono>
 #include <filesystem>
-#include <nlohmann/json.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "../Common/PatternResultCache.hpp"
+#include "../Common/SnapshotReloader.hpp"
+#include "../Common/TranslationBundle.hpp"
+#include "../Common/TranslationTemplates.hpp"
 
 
 class TranslationManager
 {
+	// Everything built from one version of the translation files, replaced as a whole on reload
+	struct Snapshot
+	{
+		TranslationBundle translations;
+		TranslationTemplates templates;
+
+		// Matched pattern results, looked up and added by the hooks without locking
+		mutable PatternResultCache patternResults;
+	};
+
 public:
+	// Keeps the translations returned while it is held alive across a reload
+	using ReadGuard = SnapshotReloader<Snapshot>::ReadGuard;
+
 	static TranslationManager& GetInstance()
 	{
 		static TranslationManager instance;
 		return instance;
 	}
 
-	static void LoadTranslations(const std::filesystem::path& translationFilePath = "redirects")
+	//
+	// Load the translations on a worker thread and reload them whenever the files change.
+	// Nothing is translated until the first load finished.
+	//
+	static void StartLoading(const std::filesystem::path& translationFilePath = "redirects")
 	{
-		GetInstance().loadTranslations(translationFilePath);
+		GetInstance().startLoading(translationFilePath);
+	}
+
+	static void StopWatching()
+	{
+		GetInstance().m_snapshots.Detach();
+	}
+
+	// Free all translations at once, only allowed after the hooks were detached
+	static void ReleaseTranslations()
+	{
+		GetInstance().m_snapshots.Release();
 	}
 
 	static std::size_t GetTranslationCount()
 	{
-		return GetInstance().m_translations.size();
+		const ReadGuard translations = Read();
+		return translations ? translations->translations.Size() : 0;
 	}
 
-	static std::string GetTranslation(const std::string& key)
+	static std::size_t GetPatternCount()
 	{
-		return GetInstance().getTranslation(key);
+		const ReadGuard translations = Read();
+		return translations ? translations->templates.Size() : 0;
 	}
 
-	static std::wstring GetTranslationW(const std::wstring& key);
+	static BundleLookupStats GetLookupStats()
+	{
+		const ReadGuard translations = Read();
+		return translations ? translations->translations.GetLookupStats() : BundleLookupStats();
+	}
+
+	static ReadGuard Read()
+	{
+		return GetInstance().m_snapshots.Read();
+	}
+
+	// Returns the null terminated translation and its length or nullptr if there is none or
+	// it is empty, see lookupTranslation. The text stays valid while the guard it was looked
+	// up with is held.
+	static const wchar_t* GetTranslationW(const ReadGuard& translations, const std::wstring_view& key, std::size_t& length, const bool& asFormat = false);
 
 private:
 	TranslationManager() = default;
 
-	std::string getTranslation(const std::string& key);
+	void loadTranslation(const std::filesystem::path& translationFilePath, TranslationBundleBuilder& builder) const;
+	void startLoading(const std::filesystem::path& translationFilePath);
+
+	std::unique_ptr<Snapshot> loadInitialSnapshot(const std::filesystem::path& translationFilePath, const std::chrono::steady_clock::time_point& startTime) const;
+	std::unique_ptr<Snapshot> reloadSnapshot(const std::filesystem::path& translationFilePath) const;
+
+	// The files are compiled on as many threads as there are cores, up to a limit
+	std::unique_ptr<Snapshot> loadSnapshot(const std::filesystem::path& translationFilePath) const;
 
-	void postProcessTranslations(nlohmann::json& translations);
-	nlohmann::json loadTranslation(const std::filesystem::path& translationFilePath);
-	void loadTranslations(const std::filesystem::path& translationFilePath);
+	static std::filesystem::path getBundlePath(const std::filesystem::path& translationFilePath);
 
 private:
-	nlohmann::json m_translations;
+	SnapshotReloader<Snapshot> m_snapshots;
 };
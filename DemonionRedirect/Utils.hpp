@@ -30,74 +30,37 @@
 #include <format>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <windows.h>
 
 #include <nlohmann/json.hpp>
 
+#include "../Common/Cp932Transcoder.hpp"
+#include "../Common/Utf16Transcoder.hpp"
+
 inline std::string sjis2utf8(const char* sjis)
 {
-	int len = MultiByteToWideChar(932, 0, sjis, -1, NULL, 0);
-	std::wstring wstr;
-	wstr.resize(len);
-	MultiByteToWideChar(932, 0, sjis, -1, &wstr[0], len);
-
-	len = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), -1, NULL, 0, NULL, NULL);
-	std::string utf8;
-	utf8.resize(len);
-	WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), -1, &utf8[0], len, NULL, NULL);
-
-	// Remove the null terminator added by WideCharToMultiByte
-	if (!utf8.empty() && utf8.back() == '\0')
-		utf8.pop_back();
-
-	return utf8;
+	return Cp932Transcoder::ToUtf8(sjis);
 }
 
 inline std::string utf82sjis(const std::string& utf8)
 {
-	int len = MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, NULL, 0);
-	std::wstring wstr;
-	wstr.resize(len);
-	MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, &wstr[0], len);
-
-	len = WideCharToMultiByte(932, 0, wstr.c_str(), -1, NULL, 0, NULL, NULL);
-	std::string sjis;
-	sjis.resize(len);
-	WideCharToMultiByte(932, 0, wstr.c_str(), -1, &sjis[0], len, NULL, NULL);
-
-	// Remove the null terminator added by WideCharToMultiByte
-	if (!sjis.empty() && sjis.back() == '\0')
-		sjis.pop_back();
-
-	return sjis;
+	return Cp932Transcoder::FromUtf8(utf8);
 }
 
+// wchar_t holds UTF-16 on Windows
+static_assert(sizeof(wchar_t) == sizeof(char16_t));
+
 inline std::string unicode2utf8(const std::wstring& unicode)
 {
-	int len = WideCharToMultiByte(CP_UTF8, 0, unicode.c_str(), -1, NULL, 0, NULL, NULL);
-	std::string utf8;
-	utf8.resize(len);
-	WideCharToMultiByte(CP_UTF8, 0, unicode.c_str(), -1, &utf8[0], len, NULL, NULL);
-
-	// Remove the null terminator added by WideCharToMultiByte
-	if (!utf8.empty() && utf8.back() == '\0')
-		utf8.pop_back();
-
-	return utf8;
+	return Utf16Transcoder::ToUtf8(std::u16string_view(reinterpret_cast<const char16_t*>(unicode.data()), unicode.size()));
 }
 
 inline std::wstring utf82unicode(const std::string& utf8)
 {
-	int len = MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, NULL, 0);
-	std::wstring unicode;
-	unicode.resize(len);
-	MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, &unicode[0], len);
-
-	// Remove the null terminator added by MultiByteToWideChar
-	if (!unicode.empty() && unicode.back() == L'\0')
-		unicode.pop_back();
-
+	std::wstring unicode(Utf16Transcoder::MaxUtf16Size(utf8.size()), L'\0');
+	unicode.resize(Utf16Transcoder::FromUtf8(utf8.data(), utf8.size(), reinterpret_cast<char16_t*>(unicode.data())));
 	return unicode;
 }
 
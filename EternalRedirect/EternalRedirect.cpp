@@ -24,14 +24,25 @@
  *
  */
 
+#include <chrono>
+#include <cstring>
 #include <fstream>
+#include <memory>
 #include <stdio.h>
+#include <string>
+#include <utility>
 #include <vector>
 #include <windows.h>
 
 #include <detours.h>
-#include <nlohmann/json.hpp>
 
+#include "../Common/ImageScanner.hpp"
+#include "../Common/ScratchBuffer.hpp"
+#include "../Common/SnapshotReloader.hpp"
+#include "../Common/TranslationBundle.hpp"
+#include "../Common/TranslationCompiler.hpp"
+#include "../Common/TranslationPointerCache.hpp"
+#include "Signatures.hpp"
 #include "Utils.hpp"
 
 #include "Logging.hpp"
@@ -49,15 +60,21 @@ VOID DetDetach(PVOID* ppbReal, PVOID pbMine, const char* psz);
 struct TranslationEntry
 {
 	TranslationEntry() = default;
-	TranslationEntry(const std::string& t, const uint32_t& pl) :
-		text(t), pixelLength(pl) {}
 
-	std::string text     = "";
+	// The text is copied, the line it came from belongs to a snapshot that may be retired
+	// before the entry is used again. Assigning reuses the capacity of the previous text.
+	void assign(const char* t, const uint32_t& pl)
+	{
+		text.assign(t);
+		pixelLength = pl;
+	}
+
+	std::string text     = {};
 	uint32_t pixelLength = 0;
 
 	void clear()
 	{
-		text        = "";
+		text.clear();
 		pixelLength = 0;
 	}
 
@@ -72,17 +89,27 @@ struct TranslationEntry
 	}
 };
 
-nlohmann::json g_translations;
+//
+// Everything built from one version of the translation files, replaced as a whole on reload
+//
+struct TranslationSnapshot
+{
+	TranslationBundle translations;
+	mutable TranslationPointerCache pointerCache;
+};
+
+SnapshotReloader<TranslationSnapshot> g_translations;
+using TranslationGuard = SnapshotReloader<TranslationSnapshot>::ReadGuard;
 TranslationEntry g_largestCopiedStrSinceResize = {};
 
-static const std::string TRANSLATIONS_FILE = "tr.json";
-static const std::string WINDOW_TITLE_KEY  = "window_title";
+// Address ranges of the read-only sections of the executable, the strings in them never change
+std::vector<std::pair<uintptr_t, uintptr_t>> g_constantRanges;
+
+// Start of ProcessAttach, the time until the translations are ready is measured from here
+std::chrono::steady_clock::time_point g_attachTime;
 
-static const std::vector<BYTE> DRAW_FORMAT_VSTRING_FUNC          = { 0x40, 0x53, 0x55, 0x56, 0x41, 0x56, 0x41, 0x57, 0x48, 0x81 };
-static const std::vector<BYTE> COPY_FUNC                         = { 0x48, 0x89, 0x5C, 0x24, 0x10, 0x57, 0x48, 0x83, 0xEC, 0x20, 0x48, 0x8B, 0xF9, 0x48, 0xC7, 0xC3 };
-static const std::vector<BYTE> GET_DRAW_FORMAT_STRING_WIDTH_FUNC = { 0x48, 0x89, 0x4C, 0x24, 0x08, 0x48, 0x89, 0x54, 0x24, 0x10, 0x4C, 0x89, 0x44, 0x24, 0x18, 0x4C, 0x89, 0x4C, 0x24, 0x20, 0x53, 0x56 };
-static const std::vector<BYTE> SET_WINDOW_TITLE_FUNC             = { 0x48, 0x89, 0x5C, 0x24, 0x20, 0x55, 0x56, 0x57, 0x41, 0x55, 0x41, 0x57, 0x48, 0x81, 0xEC, 0x40, 0x04, 0x00, 0x00, 0x48, 0x8B, 0x05, 0xA6, 0x92 };
-static const std::vector<BYTE> COPY_ENEMY_NAME_FUNC              = { 0x40, 0x53, 0x55, 0x57, 0x41, 0x56, 0x48, 0x83, 0xEC, 0x28, 0x48, 0xBF, 0xFF, 0xFF, 0xFF, 0xFF };
+static const std::string TRANSLATIONS_FILE        = "tr.json";
+static const std::string TRANSLATIONS_BUNDLE_FILE = "tr.bin";
 
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -101,65 +128,180 @@ extern "C"
 
 	typedef VOID*(WINAPI* CopyEnemyNameFunc)(void* a1, uint8_t* a2, size_t a3);
 	CopyEnemyNameFunc Real_CopyEnemyNameFunc = nullptr;
+
+	// Entry point of the game, only detoured until the hooks were set up
+	DWORD(WINAPI* Real_EntryPoint)(LPVOID pPeb) = nullptr;
 }
 
 //
 //
 //////////////////////////////////////////////////////////////////////////////
 
-bool getEntryAndCheck(const std::string& key, nlohmann::json& outEntry)
+//
+// Load the translations, a packed bundle is mapped and used in place. Without one or
+// if the JSON file is newer, the JSON file is compiled into the same format in memory.
+//
+std::unique_ptr<TranslationSnapshot> loadTranslations()
 {
-	if (g_translations.contains(key))
+	std::unique_ptr<TranslationSnapshot> pSnapshot = std::make_unique<TranslationSnapshot>();
+
+	if (isBundleCurrent(TRANSLATIONS_BUNDLE_FILE, { TRANSLATIONS_FILE }) && pSnapshot->translations.Open(TRANSLATIONS_BUNDLE_FILE))
 	{
-		const nlohmann::json& entry = g_translations[key];
-		if (!entry.contains("text") || !entry.contains("pixel_lengths"))
-			return false;
+		if (pSnapshot->translations.GetKeyEncoding() == BundleKeyEncoding::CP932)
+			return pSnapshot;
 
-		outEntry = entry;
-		return true;
+#if INCLUDE_DEBUG_LOGGING
+		Syelog(SYELOG_SEVERITY_WARNING, "### Warning: %s is not CP932 keyed, ignoring it\n", TRANSLATIONS_BUNDLE_FILE.c_str());
+#endif
+		pSnapshot->translations.Clear();
 	}
-	return false;
+
+	std::ifstream i(TRANSLATIONS_FILE);
+	if (!i.is_open())
+		return nullptr;
+
+	TranslationEncoders encoders;
+	encoders.toSjis = utf82sjis;
+
+	TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+	[[maybe_unused]] const std::vector<std::string> textOnlyKeys = compileEternalTranslations(i, builder, encoders);
+
+#if INCLUDE_DEBUG_LOGGING
+	for (const std::string& key : textOnlyKeys)
+		Syelog(SYELOG_SEVERITY_WARNING, "### Warning: The translation of %s is not used as a format, its conversions do not match the original\n", utf82sjis(key).c_str());
+#endif
+
+	if (!pSnapshot->translations.Load(builder.Build()))
+		return nullptr;
+
+	return pSnapshot;
 }
 
-//////////////////////////////////////////////////////////////////////////////
-// Detours
 //
+// Called on the watcher thread whenever the translation files changed
+//
+std::unique_ptr<TranslationSnapshot> reloadTranslations()
+{
+	try
+	{
+		std::unique_ptr<TranslationSnapshot> pSnapshot = loadTranslations();
+#if INCLUDE_DEBUG_LOGGING
+		if (pSnapshot)
+			Syelog(SYELOG_SEVERITY_INFORMATION, "### Reloaded %d translations.\n", pSnapshot->translations.Size());
+#endif
+		return pSnapshot;
+	}
+	catch ([[maybe_unused]] const std::exception& e)
+	{
+#if INCLUDE_DEBUG_LOGGING
+		Syelog(SYELOG_SEVERITY_WARNING, "### Warning: Reloading the translations failed: %s\n", e.what());
+#endif
+		return nullptr;
+	}
+}
 
-VOID* WINAPI Mine_CopyEnemyNameFunc(void* a1, uint8_t* a2, size_t a3)
+//
+// Called once on the watcher thread after the hooks were attached, which pass
+// every string through until the translations are published
+//
+std::unique_ptr<TranslationSnapshot> loadInitialTranslations()
 {
-	VOID* result = nullptr;
+#if INCLUDE_DEBUG_LOGGING
+	Syelog(SYELOG_SEVERITY_INFORMATION, "### Loading translations...\n");
+#endif
 
-	std::string utf8String = sjis2utf8(reinterpret_cast<const char*>(a2));
-	// Check if this string exists in the translations
-	if (g_translations.contains(utf8String))
+	try
 	{
-		nlohmann::json entry;
+		std::unique_ptr<TranslationSnapshot> pSnapshot = loadTranslations();
 
-		if (!getEntryAndCheck(utf8String, entry))
-			return Real_CopyEnemyNameFunc(a1, a2, a3);
+#if INCLUDE_DEBUG_LOGGING
+		const long long readyTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - g_attachTime).count();
+
+		if (pSnapshot)
+			Syelog(SYELOG_SEVERITY_INFORMATION, "### Loaded %d translations, ready %lld ms after attaching.\n", pSnapshot->translations.Size(), readyTime);
+		else
+			Syelog(SYELOG_SEVERITY_WARNING, "### Warning: Could not open %s or %s\n", TRANSLATIONS_BUNDLE_FILE.c_str(), TRANSLATIONS_FILE.c_str());
+#endif
 
-		std::string tStr = utf82sjis(entry["text"]);
-		uint8_t* pBuffer = new uint8_t[tStr.size() + 1]();
-		memcpy(pBuffer, tStr.c_str(), tStr.size());
-		result = Real_CopyEnemyNameFunc(a1, pBuffer, tStr.size());
-		delete[] pBuffer;
+		return pSnapshot;
+	}
+	catch ([[maybe_unused]] const std::exception& e)
+	{
+#if INCLUDE_DEBUG_LOGGING
+		Syelog(SYELOG_SEVERITY_FATAL, "### Error loading translations: %s\n", e.what());
+#endif
+		return nullptr;
 	}
-	else
-		result = Real_CopyEnemyNameFunc(a1, a2, a3);
-	return result;
 }
 
-int64_t WINAPI Mine_SetWindowTitle(const char* WindowText)
+void determineConstantRanges()
 {
-	int64_t result = -1;
+	const PeImage image  = getModuleImage();
+	const uintptr_t base = reinterpret_cast<uintptr_t>(image.GetData());
 
-	// Check if this string exists in the translations
-	if (g_translations.contains(WINDOW_TITLE_KEY))
+	// Writable sections like .data hold strings the game changes, e.g. "HP 100" becoming "HP 150"
+	for (const PeSection& section : image.GetSections())
 	{
-		std::string translatedString = g_translations[WINDOW_TITLE_KEY];
+		if (!section.IsWritable())
+			g_constantRanges.emplace_back(base + section.virtualAddress, base + section.virtualAddress + image.GetSectionSize(section));
+	}
+}
+
+bool isConstantString(const char* pKey)
+{
+	const uintptr_t address = reinterpret_cast<uintptr_t>(pKey);
 
-		result = Real_SetWindowTitle(translatedString.c_str());
+	for (const auto& [begin, end] : g_constantRanges)
+	{
+		if (address >= begin && address < end)
+			return true;
 	}
+
+	return false;
+}
+
+//
+// Look up a string in the translations held by the guard, the record is only valid while
+// it is held. Strings stored in the read-only sections of the executable are constant, so
+// their lookups are cached by address.
+//
+TranslationRecord findTranslation(const TranslationGuard& translations, const char* pKey)
+{
+	const TranslationSnapshot* pSnapshot = translations.Get();
+	if (pSnapshot == nullptr)
+		return {};
+
+	if (isConstantString(pKey))
+		return pSnapshot->pointerCache.Find(pSnapshot->translations, pKey);
+
+	return pSnapshot->translations.Find(pKey);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// Detours
+//
+
+VOID* WINAPI Mine_CopyEnemyNameFunc(void* a1, uint8_t* a2, size_t a3)
+{
+	// Check if this string exists in the translations
+	const TranslationGuard translations = g_translations.Read();
+	const TranslationRecord record = findTranslation(translations, reinterpret_cast<const char*>(a2));
+	if (!record)
+		return Real_CopyEnemyNameFunc(a1, a2, a3);
+
+	uint8_t* pText = reinterpret_cast<uint8_t*>(const_cast<char*>(record.GetText()));
+	return Real_CopyEnemyNameFunc(a1, pText, record.GetTextLength());
+}
+
+int64_t WINAPI Mine_SetWindowTitle(const char* WindowText)
+{
+	int64_t result = -1;
+
+	// Check if a translated window title exists
+	const TranslationGuard translations = g_translations.Read();
+	const TranslationRecord record = findTranslation(translations, WINDOW_TITLE_KEY.c_str());
+	if (record)
+		result = Real_SetWindowTitle(record.GetText());
 	else
 		result = Real_SetWindowTitle(WindowText);
 
@@ -170,31 +312,25 @@ int64_t WINAPI Mine_GetDrawFormatStringWidth(const char* FormatString, ...)
 {
 	int64_t result = -1;
 
-	std::string utf8String = sjis2utf8(FormatString);
-
 	// Check if this string exists in the translations
-	if (g_translations.contains(utf8String))
+	const TranslationGuard translations = g_translations.Read();
+	const TranslationRecord record = findTranslation(translations, FormatString);
+	if (record)
 	{
-		nlohmann::json entry;
-
-		if (!getEntryAndCheck(utf8String, entry))
-			return Real_GetDrawFormatStringWidth(FormatString);
-
-		std::string tStr = entry["text"];
-
-		const std::vector<uint32_t> pixelLengths = entry["pixel_lengths"].get<std::vector<uint32_t>>();
+		const char* pText = record.GetText();
 
 		// This should only have a single entry so just take the first -- Maybe expand later if needed
-		const uint32_t pixelLength = pixelLengths.empty() ? 0 : pixelLengths[0];
+		const uint32_t pixelLength = record.GetPixelLength(0);
 
 		// Now determine which is the largest string
 		if (g_largestCopiedStrSinceResize > pixelLength)
-			tStr = g_largestCopiedStrSinceResize.text;
+			pText = g_largestCopiedStrSinceResize.text.c_str();
+
+		// The translated text is measured as it is drawn, it is not used as a format
+		result = Real_GetDrawFormatStringWidth("%s", pText);
 
 		// Clear the largest string since resize after using it
 		g_largestCopiedStrSinceResize.clear();
-		tStr   = utf82sjis(tStr);
-		result = Real_GetDrawFormatStringWidth(tStr.c_str());
 	}
 	else
 	{
@@ -206,71 +342,87 @@ int64_t WINAPI Mine_GetDrawFormatStringWidth(const char* FormatString, ...)
 
 VOID* WINAPI Mine_CopyFunc(void* a1, uint8_t* a2, int64_t a3)
 {
-	VOID* result = nullptr;
-
-	std::string utf8String = sjis2utf8(reinterpret_cast<const char*>(a2));
 	// Check if this string exists in the translations
-	if (g_translations.contains(utf8String))
+	const TranslationGuard translations = g_translations.Read();
+	const TranslationRecord record = findTranslation(translations, reinterpret_cast<const char*>(a2));
+	if (!record)
+		return Real_CopyFunc(a1, a2, a3);
+
+	// Find the largest line by pixel length
+	for (size_t i = 0; i < record.GetLineCount(); i++)
 	{
-		nlohmann::json entry;
+		if (i < record.GetPixelLengthCount() && g_largestCopiedStrSinceResize < record.GetPixelLength(i))
+			g_largestCopiedStrSinceResize.assign(record.GetLine(i), record.GetPixelLength(i));
+	}
 
-		if (!getEntryAndCheck(utf8String, entry))
-			return Real_CopyFunc(a1, a2, a3);
+	uint8_t* pText = reinterpret_cast<uint8_t*>(const_cast<char*>(record.GetText()));
+	return Real_CopyFunc(a1, pText, a3);
+}
 
-		std::string tStr                   = entry["text"];
-		std::vector<uint32_t> pixelLengths = entry["pixel_lengths"].get<std::vector<uint32_t>>();
-		std::vector<std::string> lines     = splitString(tStr, '\n');
+int WINAPI Mine_DrawFormatVStringToHandle(int x, int y, unsigned int Color, int FontHandle, const char* FormatString, ...)
+{
+	g_largestCopiedStrSinceResize.clear();
 
-		// Find the largest line by pixel length
-		for (size_t i = 0; i < lines.size(); i++)
-		{
-			if (i < pixelLengths.size() && g_largestCopiedStrSinceResize < pixelLengths[i])
-				g_largestCopiedStrSinceResize = TranslationEntry(lines[i], pixelLengths[i]);
-		}
+	// Translations are keyed on the format template itself, so strings with embedded
+	// numbers or names are matched as well and constant format strings hit the pointer cache
+	const TranslationGuard translations = g_translations.Read();
+	TranslationRecord record = findTranslation(translations, FormatString);
 
-		tStr = utf82sjis(tStr);
+	// Nothing to format, pass the string along as is. Translations are only checked to read
+	// the same arguments as their original if it has a conversion, so this one is no format.
+	if (std::strchr(FormatString, '%') == nullptr)
+	{
+		if (record)
+			return Real_DrawFormatVStringToHandle(x, y, Color, FontHandle, "%s", record.GetText());
 
-		uint8_t* pBuffer = new uint8_t[tStr.size() + 1]();
-		memcpy(pBuffer, tStr.c_str(), tStr.size());
-		result = Real_CopyFunc(a1, pBuffer, a3);
-		delete[] pBuffer;
+		return Real_DrawFormatVStringToHandle(x, y, Color, FontHandle, FormatString);
 	}
-	else
-		result = Real_CopyFunc(a1, a2, a3);
 
-	return result;
-}
+	// A translation that reads other arguments than the template is only a text, e.g. a copied
+	// "10% damage", so the template is formatted as is and the formatted text looked up below
+	if (record && !record.IsUsableAsFormat())
+		record = TranslationRecord();
 
-int WINAPI Mine_DrawFormatVStringToHandle(int x, int y, unsigned int Color, int FontHandle, const char* FormatString, ...)
-{
-	int result = -1;
+	const char* pFormat = record ? record.GetText() : FormatString;
+
+	// Every thread formats into a buffer of its own that only grows, so drawing text does not allocate
+	thread_local ScratchBuffer<char> buffer;
+	const char* pText = pFormat;
 
-	char buffer[4096];
 	va_list args;
 	va_start(args, FormatString);
-	vsnprintf(buffer, sizeof(buffer), FormatString, args);
-	va_end(args);
-
-	std::string utf8String = sjis2utf8(buffer);
 
-	g_largestCopiedStrSinceResize.clear();
+	// Translated templates may reorder the arguments, e.g. "%2$s %1$d", which requires the positional printf variants
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	const int length = record ? _vscprintf_p(pFormat, argsCopy) : _vscprintf(pFormat, argsCopy);
+	va_end(argsCopy);
 
-	// Check if this string exists in the translations
-	if (g_translations.contains(utf8String))
+	if (length >= 0)
 	{
-		nlohmann::json entry;
+		char* pBuffer = buffer.Reserve(static_cast<std::size_t>(length));
+
+		if (record)
+			_vsprintf_p(pBuffer, static_cast<std::size_t>(length) + 1, pFormat, args);
+		else
+			vsnprintf(pBuffer, static_cast<std::size_t>(length) + 1, pFormat, args);
 
-		if (!getEntryAndCheck(utf8String, entry))
-			return Real_DrawFormatVStringToHandle(x, y, Color, FontHandle, buffer);
+		pText = pBuffer;
+	}
 
-		const std::string tStr = utf82sjis(entry["text"]);
+	va_end(args);
 
-		result = Real_DrawFormatVStringToHandle(x, y, Color, FontHandle, tStr.c_str());
+	// Catalogues keyed on the formatted text, e.g. of "%s" draws or with the numbers already
+	// filled in, still apply if the template has no translation of its own
+	if (!record)
+	{
+		const TranslationRecord formattedRecord = findTranslation(translations, pText);
+		if (formattedRecord)
+			pText = formattedRecord.GetText();
 	}
-	else
-		result = Real_DrawFormatVStringToHandle(x, y, Color, FontHandle, buffer);
 
-	return result;
+	// The formatted text can contain '%' from the arguments, so it must not be used as the format
+	return Real_DrawFormatVStringToHandle(x, y, Color, FontHandle, "%s", pText);
 }
 
 //
@@ -389,30 +541,105 @@ BOOL ThreadDetach([[maybe_unused]] HMODULE hDll)
 	return TRUE;
 }
 
-template<typename T>
-void SetupHook(T& realFuncPtr, const std::vector<BYTE>& funcBytes, const char* funcName)
+struct PatternHook
 {
-	realFuncPtr        = nullptr;
-	uintptr_t funcAddr = findFunction(funcBytes);
+	PVOID* ppRealFunc;
+	const FunctionSignature* pSignature;
+};
+
+//
+// Find the functions of all hooks, every section is only scanned once for all patterns.
+// Inside DllMain the thread count has to be 1.
+//
+void SetupHooks(const std::vector<PatternHook>& hooks, const std::size_t& threadCount)
+{
+	ImageScanner scanner(getModuleImage(), threadCount);
+	for (const PatternHook& hook : hooks)
+		scanner.Add(hook.pSignature->pattern, hook.pSignature->section);
+
+	const std::vector<uintptr_t> funcAddrs = findFunctions(scanner);
 
-	if (funcAddr == ~0)
-	{
 #if INCLUDE_DEBUG_LOGGING
-		Syelog(SYELOG_SEVERITY_FATAL, "### Error: Unable to find the %s function\n", funcName);
+	Syelog(SYELOG_SEVERITY_INFORMATION, "### Took %zu of %zu hooks from the address cache, scanned %zu of %u image bytes\n", scanner.GetCachedCount(), scanner.Size(), scanner.GetScannedBytes(), scanner.GetImage().GetSizeOfImage());
 #endif
-		return;
-	}
-	else
+
+	for (std::size_t i = 0; i < hooks.size(); i++)
 	{
+		const PatternHook& hook = hooks[i];
+		*hook.ppRealFunc        = nullptr;
+
+		if (funcAddrs[i] == ~0)
+		{
+#if INCLUDE_DEBUG_LOGGING
+			Syelog(SYELOG_SEVERITY_FATAL, "### Error: Unable to find the %s function\n", hook.pSignature->name);
+#endif
+			continue;
+		}
+		else
+		{
 #if INCLUDE_DEBUG_LOGGING
-		Syelog(SYELOG_SEVERITY_INFORMATION, "### Found %s function at address: 0x%p\n", funcName, reinterpret_cast<void*>(funcAddr));
+			Syelog(SYELOG_SEVERITY_INFORMATION, "### Found %s function at address: 0x%p\n", hook.pSignature->name, reinterpret_cast<void*>(funcAddrs[i]));
 #endif
+		}
+
+		*hook.ppRealFunc = reinterpret_cast<PVOID>(funcAddrs[i]);
 	}
+}
 
-	realFuncPtr = reinterpret_cast<T>(funcAddr);
+void SetupDetours(const std::size_t& threadCount)
+{
+	const std::vector<PatternHook> hooks = {
+		{ (PVOID*)&Real_DrawFormatVStringToHandle, &DRAW_FORMAT_VSTRING_FUNC },
+		{ (PVOID*)&Real_CopyFunc, &COPY_FUNC },
+		{ (PVOID*)&Real_GetDrawFormatStringWidth, &GET_DRAW_FORMAT_STRING_WIDTH_FUNC },
+		{ (PVOID*)&Real_SetWindowTitle, &SET_WINDOW_TITLE_FUNC },
+		{ (PVOID*)&Real_CopyEnemyNameFunc, &COPY_ENEMY_NAME_FUNC },
+	};
+
+	SetupHooks(hooks, threadCount);
+
+	LONG error = AttachDetours();
+
+#if INCLUDE_DEBUG_LOGGING
+	if (error != NO_ERROR)
+		Syelog(SYELOG_SEVERITY_FATAL, "### Error attaching detours: %d\n", error);
+
+	Syelog(SYELOG_SEVERITY_NOTICE, "### Attached.\n");
+#endif
+}
+
+DWORD WINAPI Mine_EntryPoint(LPVOID pPeb)
+{
+	// The entry point only runs once, so it is restored before the game starts
+	DetourTransactionBegin();
+	DetourUpdateThread(GetCurrentThread());
+	DetourDetach((PVOID*)&Real_EntryPoint, Mine_EntryPoint);
+	DetourTransactionCommit();
+
+	// The loader lock was released, so large images are scanned on all cores
+	SetupDetours(0);
+
+	return Real_EntryPoint(pPeb);
 }
 
-BOOL ProcessAttach(HMODULE hDll)
+//
+// Set up the hooks from the entry point of the game instead of DllMain, where the scan
+// can not use worker threads. Returns false if the entry point could not be detoured.
+//
+bool HookEntryPoint()
+{
+	Real_EntryPoint = reinterpret_cast<DWORD(WINAPI*)(LPVOID)>(DetourGetEntryPoint(NULL));
+	if (Real_EntryPoint == nullptr)
+		return false;
+
+	DetourTransactionBegin();
+	DetourUpdateThread(GetCurrentThread());
+	DetourAttach((PVOID*)&Real_EntryPoint, Mine_EntryPoint);
+
+	return DetourTransactionCommit() == NO_ERROR;
+}
+
+BOOL ProcessAttach(HMODULE hDll, const bool& loadedWithGame)
 {
 #if INCLUDE_DEBUG_LOGGING
 	WCHAR wzExeName[MAX_PATH];
@@ -422,40 +649,22 @@ BOOL ProcessAttach(HMODULE hDll)
 	SyelogOpen("eternal" DETOURS_STRINGIFY(DETOURS_BITS), SYELOG_FACILITY_APPLICATION);
 	Syelog(SYELOG_SEVERITY_INFORMATION, "##################################################################\n");
 	Syelog(SYELOG_SEVERITY_INFORMATION, "### %ls\n", wzExeName);
-
-	Syelog(SYELOG_SEVERITY_INFORMATION, "### Loading translations...\n");
 #endif
 
-	std::ifstream i(TRANSLATIONS_FILE);
-	if (i.is_open())
-	{
-		i >> g_translations;
+	g_attachTime = std::chrono::steady_clock::now();
 
-#if INCLUDE_DEBUG_LOGGING
-		Syelog(SYELOG_SEVERITY_INFORMATION, "### Loaded %d translations.\n", g_translations.size());
-#endif
-	}
-	else
-	{
-#if INCLUDE_DEBUG_LOGGING
-		Syelog(SYELOG_SEVERITY_WARNING, "### Warning: Could not open %s\n", TRANSLATIONS_FILE.c_str());
-#endif
-	}
+	determineConstantRanges();
 
-	SetupHook(Real_DrawFormatVStringToHandle, DRAW_FORMAT_VSTRING_FUNC, "DrawFormatVStringToHandle");
-	SetupHook(Real_CopyFunc, COPY_FUNC, "CopyFunc");
-	SetupHook(Real_GetDrawFormatStringWidth, GET_DRAW_FORMAT_STRING_WIDTH_FUNC, "GetDrawFormatStringWidth");
-	SetupHook(Real_SetWindowTitle, SET_WINDOW_TITLE_FUNC, "SetWindowTitle");
-	SetupHook(Real_CopyEnemyNameFunc, COPY_ENEMY_NAME_FUNC, "CopyEnemyNameFunc");
+	// Loaded through the import table the game did not start yet, otherwise the hooks are needed right away
+	if (!loadedWithGame || !HookEntryPoint())
+		SetupDetours(1);
 
-	LONG error = AttachDetours();
+	// The watcher thread runs code of this module until the process exits, so it must never be unloaded
+	HMODULE hPinned = NULL;
+	GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_PIN, reinterpret_cast<LPCWSTR>(hDll), &hPinned);
 
-#if INCLUDE_DEBUG_LOGGING
-	if (error != NO_ERROR)
-		Syelog(SYELOG_SEVERITY_FATAL, "### Error attaching detours: %d\n", error);
-
-	Syelog(SYELOG_SEVERITY_NOTICE, "### Attached.\n");
-#endif
+	// Load the translations off the loader lock and pick up changes to the files while the game is running
+	g_translations.Start({ TRANSLATIONS_BUNDLE_FILE, TRANSLATIONS_FILE }, reloadTranslations, loadInitialTranslations);
 
 	ThreadAttach(hDll);
 
@@ -466,6 +675,8 @@ BOOL ProcessAttach(HMODULE hDll)
 
 BOOL ProcessDetach(HMODULE hDll)
 {
+	g_translations.Detach();
+
 	ThreadDetach(hDll);
 
 	logging::SetBLog(FALSE);
@@ -476,19 +687,31 @@ BOOL ProcessDetach(HMODULE hDll)
 	if (error != NO_ERROR)
 		Syelog(SYELOG_SEVERITY_FATAL, "### Error detaching detours: %d\n", error);
 
+	{
+		const TranslationGuard translations = g_translations.Read();
+		if (translations)
+		{
+			const BundleLookupStats stats = translations->translations.GetLookupStats();
+			Syelog(SYELOG_SEVERITY_INFORMATION, "### Lookups: %llu, hits: %llu, filter skips: %llu, false positives: %llu (%.2f%%)\n", stats.lookups, stats.hits, stats.filterSkips, stats.falsePositives, stats.GetFalsePositiveRate() * 100.0);
+		}
+	}
+
 	Syelog(SYELOG_SEVERITY_NOTICE, "### Closing.\n");
 	SyelogClose(FALSE);
 
 	logging::Cleanup();
 #endif
 
+	// Once the hooks are gone all translations can be freed in one go
+	if (error == NO_ERROR)
+		g_translations.Release();
+
 	return TRUE;
 }
 
 BOOL APIENTRY DllMain(HINSTANCE hModule, DWORD dwReason, PVOID lpReserved)
 {
 	(void)hModule;
-	(void)lpReserved;
 
 	if (DetourIsHelperProcess())
 		return TRUE;
@@ -497,7 +720,8 @@ BOOL APIENTRY DllMain(HINSTANCE hModule, DWORD dwReason, PVOID lpReserved)
 	{
 		case DLL_PROCESS_ATTACH:
 			DetourRestoreAfterWith();
-			return ProcessAttach(hModule);
+			// The reserved parameter is only set if the DLL is loaded with the game
+			return ProcessAttach(hModule, lpReserved != NULL);
 		case DLL_PROCESS_DETACH:
 			return ProcessDetach(hModule);
 		case DLL_THREAD_ATTACH:
@@ -0,0 +1,58 @@
+/*
+ *  File: Signatures.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include "../Common/SignaturePattern.hpp"
+
+struct FunctionSignature
+{
+	const char* name;
+	SignaturePattern pattern;
+
+	// Section the function is in, by default all executable sections are searched
+	const char* section = "";
+};
+
+//
+// Signatures of the hooked game functions, ?? matches any byte, e.g. the RIP relative
+// displacements that change with every build. Kept free of Windows dependencies, the
+// SignatureResolver checks them offline against new builds of the game. A short pattern at
+// a call site followed with FollowRelative can replace a prologue that changes too often.
+//
+static const FunctionSignature DRAW_FORMAT_VSTRING_FUNC          = { "DrawFormatVStringToHandle", SignaturePattern::Parse("40 53 55 56 41 56 41 57 48 81") };
+static const FunctionSignature COPY_FUNC                         = { "CopyFunc", SignaturePattern::Parse("48 89 5C 24 10 57 48 83 EC 20 48 8B F9 48 C7 C3") };
+static const FunctionSignature GET_DRAW_FORMAT_STRING_WIDTH_FUNC = { "GetDrawFormatStringWidth", SignaturePattern::Parse("48 89 4C 24 08 48 89 54 24 10 4C 89 44 24 18 4C 89 4C 24 20 53 56") };
+static const FunctionSignature SET_WINDOW_TITLE_FUNC             = { "SetWindowTitle", SignaturePattern::Parse("48 89 5C 24 20 55 56 57 41 55 41 57 48 81 EC 40 04 00 00 48 8B 05 ?? ??") };
+static const FunctionSignature COPY_ENEMY_NAME_FUNC              = { "CopyEnemyNameFunc", SignaturePattern::Parse("40 53 55 57 41 56 48 83 EC 28 48 BF FF FF FF FF") };
+
+static const FunctionSignature* const ETERNAL_SIGNATURES[] = {
+	&DRAW_FORMAT_VSTRING_FUNC,
+	&COPY_FUNC,
+	&GET_DRAW_FORMAT_STRING_WIDTH_FUNC,
+	&SET_WINDOW_TITLE_FUNC,
+	&COPY_ENEMY_NAME_FUNC,
+};
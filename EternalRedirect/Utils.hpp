@@ -26,46 +26,22 @@
 
 #pragma once
 
+#include <filesystem>
 #include <string>
 #include <vector>
 #include <windows.h>
 
+#include "../Common/Cp932Transcoder.hpp"
+#include "../Common/ModuleUtils.hpp"
+
 std::string sjis2utf8(const char* sjis)
 {
-	int len = MultiByteToWideChar(932, 0, sjis, -1, NULL, 0);
-	std::wstring wstr;
-	wstr.resize(len);
-	MultiByteToWideChar(932, 0, sjis, -1, &wstr[0], len);
-
-	len = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), -1, NULL, 0, NULL, NULL);
-	std::string utf8;
-	utf8.resize(len);
-	WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), -1, &utf8[0], len, NULL, NULL);
-
-	// Remove the null terminator added by WideCharToMultiByte
-	if (!utf8.empty() && utf8.back() == '\0')
-		utf8.pop_back();
-
-	return utf8;
+	return Cp932Transcoder::ToUtf8(sjis);
 }
 
 std::string utf82sjis(const std::string& utf8)
 {
-	int len = MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, NULL, 0);
-	std::wstring wstr;
-	wstr.resize(len);
-	MultiByteToWideChar(CP_UTF8, 0, utf8.c_str(), -1, &wstr[0], len);
-
-	len = WideCharToMultiByte(932, 0, wstr.c_str(), -1, NULL, 0, NULL, NULL);
-	std::string sjis;
-	sjis.resize(len);
-	WideCharToMultiByte(932, 0, wstr.c_str(), -1, &sjis[0], len, NULL, NULL);
-
-	// Remove the null terminator added by WideCharToMultiByte
-	if (!sjis.empty() && sjis.back() == '\0')
-		sjis.pop_back();
-
-	return sjis;
+	return Cp932Transcoder::FromUtf8(utf8);
 }
 
 std::string replaceAll(const std::string& str, const std::string& from, const std::string& to)
@@ -97,38 +73,3 @@ std::vector<std::string> splitString(const std::string& str, const char& delimit
 	tokens.push_back(str.substr(start));
 	return tokens;
 }
-
-//
-// Determine the offset for the given function
-//
-uintptr_t findFunction(const std::vector<BYTE>& tarBytes)
-{
-	const uintptr_t startAddress = reinterpret_cast<uintptr_t>(GetModuleHandleW(nullptr));
-	MEMORY_BASIC_INFORMATION info;
-	uintptr_t endAddress = startAddress;
-
-	do
-	{
-		VirtualQuery((void*)endAddress, &info, sizeof(info));
-		endAddress = (uintptr_t)info.BaseAddress + info.RegionSize;
-	} while (info.Protect > PAGE_NOACCESS);
-
-	endAddress -= info.RegionSize;
-
-	const DWORD procMemLength = static_cast<DWORD>(endAddress - startAddress);
-	const DWORD tarLength     = static_cast<DWORD>(tarBytes.size());
-	const BYTE* pProcData     = reinterpret_cast<BYTE*>(startAddress);
-
-	for (DWORD i = 0; i < procMemLength - tarLength; i++)
-	{
-		for (DWORD j = 0; j <= tarLength; j++)
-		{
-			if (j == tarLength)
-				return startAddress + i;
-			else if (pProcData[i + j] != tarBytes[j])
-				break;
-		}
-	}
-
-	return static_cast<uintptr_t>(-1);
-}
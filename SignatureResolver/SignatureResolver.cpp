@@ -0,0 +1,317 @@
+/*
+ *  File: SignatureResolver.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "../Common/AddressCache.hpp"
+#include "../Common/ImageScanner.hpp"
+#include "../Common/MappedFile.hpp"
+#include "../Common/PeImage.hpp"
+#include "../EternalRedirect/Signatures.hpp"
+
+//
+// Resolves function signatures against a game executable on disk, so new builds can be
+// checked and their addresses embedded without starting the game
+//   SignatureResolver Game.exe --eternal --cache EternalRedirect.cache
+//   SignatureResolver Game.exe signatures.json --header Offsets.hpp
+//
+// A signature file contains a list of
+//   { "name": "EXE_STRING_FUNC_3", "pattern": "55 8B EC 6A FF ?? ??", "section": ".text" }
+// The section is optional, by default all executable sections are searched. Signatures
+// near a call site can lead to the function with a list of steps applied to the match
+//   "steps": [ { "follow": 1 }, { "rip": 3, "size": 7 }, { "skip": -16 } ]
+// follow continues at the target of the rel32 at the offset, rip at the RIP-relative
+// operand at the offset of an instruction of the given size, skip moves by the offset.
+//
+
+struct Signature
+{
+	std::string name;
+	SignaturePattern pattern;
+	std::string section;
+};
+
+struct Resolution
+{
+	uint32_t rva        = ImageScanner::NOT_FOUND;
+	uint32_t matchRva   = ImageScanner::NOT_FOUND;
+	std::size_t matches = 0;
+};
+
+std::vector<Signature> readSignatures(const std::filesystem::path& path)
+{
+	std::ifstream fs(path);
+	if (!fs)
+		throw std::runtime_error("Failed to open file: " + path.string());
+
+	const nlohmann::json json = nlohmann::json::parse(fs);
+	if (!json.is_array())
+		throw std::runtime_error("The signature file has to contain a list of signatures");
+
+	std::vector<Signature> signatures;
+	for (const nlohmann::json& entry : json)
+	{
+		Signature signature;
+		signature.name    = entry.at("name").get<std::string>();
+		signature.pattern = SignaturePattern::Parse(entry.at("pattern").get<std::string>());
+		signature.section = entry.value("section", "");
+
+		for (const nlohmann::json& step : entry.value("steps", nlohmann::json::array()))
+		{
+			if (step.contains("follow"))
+				signature.pattern = signature.pattern.FollowRelative(step.at("follow").get<int32_t>());
+			else if (step.contains("rip"))
+				signature.pattern = signature.pattern.ResolveRipRelative(step.at("rip").get<int32_t>(), step.at("size").get<int32_t>());
+			else if (step.contains("skip"))
+				signature.pattern = signature.pattern.Skip(step.at("skip").get<int32_t>());
+			else
+				throw std::runtime_error("Invalid step in the signature " + signature.name + ": " + step.dump());
+		}
+
+		signatures.push_back(std::move(signature));
+	}
+
+	return signatures;
+}
+
+std::vector<Signature> getEternalSignatures()
+{
+	std::vector<Signature> signatures;
+	for (const FunctionSignature* pSignature : ETERNAL_SIGNATURES)
+		signatures.push_back({ pSignature->name, pSignature->pattern, pSignature->section });
+
+	return signatures;
+}
+
+// DrawFormatVStringToHandle becomes DRAW_FORMAT_VSTRING_TO_HANDLE, names like EXE_STRING_FUNC_3 are kept
+std::string toConstantName(const std::string& name)
+{
+	std::string result;
+
+	for (std::size_t i = 0; i < name.size(); i++)
+	{
+		const unsigned char c = static_cast<unsigned char>(name[i]);
+		if (!std::isalnum(c))
+		{
+			result.push_back('_');
+			continue;
+		}
+
+		const unsigned char prev = i > 0 ? static_cast<unsigned char>(name[i - 1]) : 0;
+		if (std::isupper(c) && (std::islower(prev) || std::isdigit(prev)))
+			result.push_back('_');
+
+		result.push_back(static_cast<char>(std::toupper(c)));
+	}
+
+	return result;
+}
+
+std::vector<Resolution> resolveSignatures(const PeImage& image, const std::vector<Signature>& signatures)
+{
+	// Offline all cores can be used
+	ImageScanner scanner(image, 0);
+	for (const Signature& signature : signatures)
+		scanner.Add(signature.pattern, signature.section);
+
+	// The RVAs come from the same scan the DLLs run, so they always agree on ambiguous signatures
+	const std::vector<uint32_t> matchRvas     = scanner.FindMatches();
+	const std::vector<std::size_t> matchCount = scanner.CountMatches();
+
+	std::vector<Resolution> resolutions(signatures.size());
+	for (std::size_t i = 0; i < signatures.size(); i++)
+	{
+		resolutions[i].rva      = scanner.Resolve(i, matchRvas[i]);
+		resolutions[i].matchRva = matchRvas[i];
+		resolutions[i].matches  = matchCount[i];
+	}
+
+	return resolutions;
+}
+
+// Constants in the style of the hard coded offsets of the DLLs
+void writeHeader(const std::filesystem::path& path, const std::filesystem::path& exePath, const PeImage& image, const std::vector<Signature>& signatures, const std::vector<Resolution>& resolutions)
+{
+	std::ofstream out(path);
+	if (!out)
+		throw std::runtime_error("Failed to create file: " + path.string());
+
+	std::size_t width = 0;
+	for (const Signature& signature : signatures)
+		width = std::max(width, toConstantName(signature.name).size() + 7);
+
+	out << "// Generated by the SignatureResolver from " << exePath.filename().string() << std::endl;
+	out << "// TimeDateStamp: 0x" << std::hex << std::uppercase << image.GetTimeDateStamp() << ", SizeOfImage: 0x" << image.GetSizeOfImage() << std::endl;
+	out << std::endl;
+	out << "#pragma once" << std::endl;
+	out << std::endl;
+	out << "#include <cstdint>" << std::endl;
+	out << std::endl;
+
+	for (std::size_t i = 0; i < signatures.size(); i++)
+	{
+		const std::string constant = toConstantName(signatures[i].name) + "_OFFSET";
+
+		if (resolutions[i].rva == ImageScanner::NOT_FOUND)
+			out << "// " << constant << " was not found" << std::endl;
+		else
+			out << "inline constexpr uint32_t " << std::left << std::setw(static_cast<int>(width)) << constant << " = 0x" << resolutions[i].rva << ";" << std::endl;
+	}
+
+	if (!out)
+		throw std::runtime_error("Failed to write file: " + path.string());
+}
+
+// An address cache the DLLs pick up, so even the first start of the game only checks the addresses
+void writeCache(const std::filesystem::path& path, const PeImage& image, const std::vector<Signature>& signatures, const std::vector<Resolution>& resolutions)
+{
+	// Addresses of other signatures already cached for this build are kept
+	AddressCache cache;
+	cache.Load(path, AddressCache::GetFingerprint(image));
+
+	// Like the DLLs the cache holds where the patterns matched, not where their steps lead
+	for (std::size_t i = 0; i < signatures.size(); i++)
+	{
+		if (resolutions[i].matchRva != ImageScanner::NOT_FOUND)
+			cache.Set(signatures[i].pattern, signatures[i].section, resolutions[i].matchRva);
+	}
+
+	if (!cache.Save(path))
+		throw std::runtime_error("Failed to write file: " + path.string());
+}
+
+void printReport(const PeImage& image, const std::vector<Signature>& signatures, const std::vector<Resolution>& resolutions)
+{
+	const ImageFingerprint fingerprint = AddressCache::GetFingerprint(image);
+
+	std::cout << (image.Is64Bit() ? "64" : "32") << " bit image, TimeDateStamp: 0x" << std::hex << std::uppercase << fingerprint.timeDateStamp;
+	std::cout << ", SizeOfImage: 0x" << fingerprint.sizeOfImage << ", code checksum: 0x" << fingerprint.codeChecksum << std::endl;
+	std::cout << std::endl;
+
+	std::size_t width = 4;
+	for (const Signature& signature : signatures)
+		width = std::max(width, signature.name.size());
+
+	std::cout << std::left << std::setw(static_cast<int>(width)) << "Name" << "  " << std::setw(10) << "RVA" << "  Matches" << std::endl;
+
+	for (std::size_t i = 0; i < signatures.size(); i++)
+	{
+		const Resolution& resolution = resolutions[i];
+		std::cout << std::setw(static_cast<int>(width)) << signatures[i].name << "  ";
+
+		if (resolution.rva == ImageScanner::NOT_FOUND)
+			std::cout << std::setw(10) << "-";
+		else
+			std::cout << "0x" << std::setw(8) << resolution.rva;
+
+		std::cout << "  " << std::dec << resolution.matches;
+
+		if (resolution.matches > 1)
+			std::cout << " (not unique, the first match is used)";
+
+		if (resolution.matchRva != ImageScanner::NOT_FOUND && resolution.rva == ImageScanner::NOT_FOUND)
+			std::cout << " (matched at 0x" << std::hex << resolution.matchRva << ", the steps lead outside the image)";
+		else if (resolution.rva != resolution.matchRva)
+			std::cout << " (matched at 0x" << std::hex << resolution.matchRva << ")";
+
+		std::cout << std::hex << std::endl;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> args(argv + 1, argv + argc);
+	std::filesystem::path headerPath;
+	std::filesystem::path cachePath;
+
+	for (std::size_t i = 0; i + 1 < args.size();)
+	{
+		if (args[i] == "--header")
+			headerPath = args[i + 1];
+		else if (args[i] == "--cache")
+			cachePath = args[i + 1];
+		else
+		{
+			i++;
+			continue;
+		}
+
+		args.erase(args.begin() + i, args.begin() + i + 2);
+	}
+
+	if (args.size() != 2)
+	{
+		std::cout << "Usage: " << argv[0] << " <executable> <signatures|--eternal> [--header <file>] [--cache <file>]" << std::endl;
+		std::cout << "  <executable>      Game executable to resolve the signatures in" << std::endl;
+		std::cout << "  <signatures>      JSON file with the signatures, or --eternal for the ones of EternalRedirect" << std::endl;
+		std::cout << "  --header <file>   Write the RVAs as C++ constants" << std::endl;
+		std::cout << "  --cache <file>    Write the RVAs to the address cache of the DLL, e.g. EternalRedirect.cache" << std::endl;
+		return 1;
+	}
+
+	const std::filesystem::path exePath = args[0];
+
+	try
+	{
+		const std::vector<Signature> signatures = args[1] == "--eternal" ? getEternalSignatures() : readSignatures(args[1]);
+
+		MappedFile file;
+		if (!file.Open(exePath))
+			throw std::runtime_error("Failed to open file: " + exePath.string());
+
+		const PeImage image(reinterpret_cast<const uint8_t*>(file.GetData()), file.GetSize(), PeLayout::File);
+		const std::vector<Resolution> resolutions = resolveSignatures(image, signatures);
+
+		printReport(image, signatures, resolutions);
+
+		if (!headerPath.empty())
+			writeHeader(headerPath, exePath, image, signatures, resolutions);
+
+		if (!cachePath.empty())
+			writeCache(cachePath, image, signatures, resolutions);
+
+		// Fails if a signature needs attention, so new game builds can be checked in scripts
+		const bool allUnique = std::all_of(resolutions.begin(), resolutions.end(), [](const Resolution& resolution) { return resolution.matches == 1 && resolution.rva != ImageScanner::NOT_FOUND; });
+		return allUnique ? 0 : 1;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+}
@@ -24,49 +24,21 @@
  *
  */
 
-#include <Windows.h>
+#include <algorithm>
 #include <exception>
 #include <format>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <vector>
 
 #include <nlohmann/json.hpp>
 
-#include "../EternalRedirect/Utils.hpp"
+#include "../Common/Cp932Transcoder.hpp"
+#include "../Common/PeImage.hpp"
 
 const std::string TARGET_SECTION_NAME = ".rdata";
 
-IMAGE_SECTION_HEADER getRDataSection(std::ifstream& file)
-{
-	IMAGE_DOS_HEADER dosHeader;
-	file.read(reinterpret_cast<char*>(&dosHeader), sizeof(dosHeader));
-
-	if (dosHeader.e_magic != IMAGE_DOS_SIGNATURE)
-		throw std::runtime_error("Invalid DOS header signature");
-
-	file.seekg(dosHeader.e_lfanew);
-	IMAGE_NT_HEADERS ntHeaders;
-	file.read(reinterpret_cast<char*>(&ntHeaders), sizeof(ntHeaders));
-
-	if (ntHeaders.Signature != IMAGE_NT_SIGNATURE)
-		throw std::runtime_error("Invalid NT header signature");
-
-	IMAGE_SECTION_HEADER sectionHeader;
-	bool found = false;
-
-	for (uint32_t i = 0; i < ntHeaders.FileHeader.NumberOfSections; i++)
-	{
-		file.read(reinterpret_cast<char*>(&sectionHeader), sizeof(sectionHeader));
-
-		const std::string secName = std::string(reinterpret_cast<char*>(sectionHeader.Name), strnlen_s(reinterpret_cast<char*>(sectionHeader.Name), IMAGE_SIZEOF_SHORT_NAME));
-		if (secName == TARGET_SECTION_NAME)
-			return sectionHeader;
-	}
-
-	throw std::runtime_error("Target section not found");
-}
-
 std::vector<char> getRData(const std::string& filename)
 {
 	std::ifstream file(filename, std::ios::binary);
@@ -75,19 +47,20 @@ std::vector<char> getRData(const std::string& filename)
 		throw std::runtime_error(std::format("Failed to open file: {}", filename));
 
 	std::cout << "Getting rdata section information ... " << std::flush;
-	IMAGE_SECTION_HEADER sec = getRDataSection(file);
-	const DWORD dataPtr      = sec.PointerToRawData;
-	const DWORD dataSize     = sec.SizeOfRawData;
+	const std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+
+	const PeImage image(fileData.data(), fileData.size(), PeLayout::File);
+
+	const PeSection* pSection = image.FindSection(TARGET_SECTION_NAME);
+	if (pSection == nullptr)
+		throw std::runtime_error("Target section not found");
+
 	std::cout << "Done" << std::endl;
 
 	std::cout << "Reading section data ... " << std::flush;
-	std::vector<char> secData;
-	secData.resize(dataSize);
-
-	// Read the section data
-	file.seekg(dataPtr);
-	file.read(secData.data(), dataSize);
-	file.close();
+	const uint8_t* pSecData = image.GetSectionData(*pSection);
+	std::vector<char> secData(pSecData, pSecData + image.GetSectionSize(*pSection));
 	std::cout << "Done" << std::endl;
 
 	return secData;
@@ -183,8 +156,7 @@ int main(int argc, char* argv[])
 
 		for (const auto& segment : outputs)
 		{
-			std::string sjisStr(segment.begin(), segment.end());
-			std::string utf8Str = sjis2utf8(sjisStr.c_str());
+			const std::string utf8Str = Cp932Transcoder::ToUtf8(std::string_view(segment.data(), segment.size()));
 			if (!j.contains(utf8Str))
 				j[utf8Str] = "";
 		}
@@ -0,0 +1,134 @@
+/*
+ *  File: TranslationPacker.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Common/Cp932Transcoder.hpp"
+#include "../Common/TranslationBundle.hpp"
+#include "../Common/TranslationCompiler.hpp"
+#include "../Common/Utf16Transcoder.hpp"
+
+//
+// Compiles the translation JSON files into a binary bundle
+//   TranslationPacker tr.json tr.bin
+//   TranslationPacker --redirect redirects redirects.bin
+//
+
+std::u16string utf82utf16(const std::string& utf8)
+{
+	return Utf16Transcoder::FromUtf8(utf8);
+}
+
+std::string utf82sjis(const std::string& utf8)
+{
+	return Cp932Transcoder::FromUtf8(utf8);
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> args(argv + 1, argv + argc);
+
+	const bool redirect = !args.empty() && args[0] == "--redirect";
+	if (redirect)
+		args.erase(args.begin());
+
+	if (args.size() != 2)
+	{
+		std::cout << "Usage: " << argv[0] << " [--redirect] <input> <output>" << std::endl;
+		std::cout << "  <input>     EternalRedirect tr.json, or with --redirect a JSON file or directory of JSON files" << std::endl;
+		std::cout << "  <output>    Bundle file to write, e.g. tr.bin" << std::endl;
+		return 1;
+	}
+
+	const std::filesystem::path input  = args[0];
+	const std::filesystem::path output = args[1];
+
+	if (!std::filesystem::exists(input))
+	{
+		std::cerr << "Error: Input \"" << input.string() << "\" not found" << std::endl;
+		return 1;
+	}
+
+	try
+	{
+		TranslationEncoders encoders;
+		encoders.toSjis = utf82sjis;
+		encoders.toWide = utf82utf16;
+
+		TranslationBundleBuilder builder(redirect ? BundleKeyEncoding::UTF16 : BundleKeyEncoding::CP932);
+
+		for (const std::filesystem::path& path : collectTranslationFiles(input))
+		{
+			std::cout << "Compiling " << path.string() << " ... " << std::flush;
+
+			std::ifstream fs(path);
+			if (!fs)
+				throw std::runtime_error("Failed to open file: " + path.string());
+
+			const std::vector<std::string> textOnlyKeys = redirect ? compileRedirectTranslations(fs, builder, encoders) : compileEternalTranslations(fs, builder, encoders);
+
+			std::cout << "Done" << std::endl;
+
+			for (const std::string& key : textOnlyKeys)
+				std::cerr << "Warning: The translation of \"" << key << "\" is not used as a format, its conversions do not match the original" << std::endl;
+		}
+
+		std::cout << "Writing bundle ... " << std::flush;
+		const std::vector<char> bundle = builder.Build();
+
+		// Written next to the output and renamed over it, so a running game never reads a partial bundle
+		std::filesystem::path tempOutput = output;
+		tempOutput += ".tmp";
+
+		std::ofstream out(tempOutput, std::ios::binary);
+		if (!out)
+			throw std::runtime_error("Failed to create file: " + tempOutput.string());
+
+		out.write(bundle.data(), static_cast<std::streamsize>(bundle.size()));
+		out.close();
+
+		if (!out)
+			throw std::runtime_error("Failed to write file: " + tempOutput.string());
+
+		std::filesystem::rename(tempOutput, output);
+
+		std::cout << "Done" << std::endl;
+		std::cout << "Total translations: " << builder.Size() << ", patterns: " << builder.GetTemplateCount() << ", bundle size: " << bundle.size() << " bytes" << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Error: " << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,246 @@
+/*
+ *  File: AsciiRunBench.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Common/Cp932Table.hpp"
+#include "../Common/Cp932Transcoder.hpp"
+#include "../Common/ScratchBuffer.hpp"
+#include "../Common/Utf16Transcoder.hpp"
+#include "../Common/Utf8.hpp"
+#include "BenchUtils.hpp"
+
+//
+// Mixed Japanese and ASCII game text as UTF-8, e.g. status lines, item names with counts,
+// control codes and partly translated messages. About asciiShare of the pieces are ASCII.
+//
+static std::vector<std::string> makeMixedStrings(const std::size_t& count, const double& asciiShare, const uint32_t& seed)
+{
+	static const char* const ASCII_PIECES[] = { "HP ", "MP ", "Lv.", "99", "/999", "\\n", "%d", "%s", "x3 ", "Potion ", "Attack ", "the ", "Slime ", "Gold", ": ", "OK" };
+	static constexpr std::size_t ASCII_COUNT = sizeof(ASCII_PIECES) / sizeof(ASCII_PIECES[0]);
+
+	static const std::string FALLBACK = "スライム";
+
+	const std::vector<std::string> japanese = makeJapaneseStrings(count, seed);
+
+	std::mt19937 rng(seed);
+	std::bernoulli_distribution asciiDist(asciiShare);
+	std::uniform_int_distribution<std::size_t> pieceDist(0, ASCII_COUNT - 1);
+	std::uniform_int_distribution<std::size_t> lengthDist(4, 40);
+
+	std::vector<std::string> strings;
+	strings.reserve(count);
+
+	for (std::size_t i = 0; i < count; i++)
+	{
+		// Generated strings made only of ASCII pieces have no character to take
+		const bool hasJapanese    = std::any_of(japanese[i].begin(), japanese[i].end(), [](const char& ch) { return static_cast<uint8_t>(ch) >= 0x80; });
+		const std::string& source = hasJapanese ? japanese[i] : FALLBACK;
+		std::size_t sourcePos     = 0;
+		std::string str;
+
+		const std::size_t length = lengthDist(rng);
+		for (std::size_t j = 0; j < length; j++)
+		{
+			if (asciiDist(rng))
+			{
+				str += ASCII_PIECES[pieceDist(rng)];
+				continue;
+			}
+
+			// The next Japanese character of the generated string, its ASCII is skipped
+			while (static_cast<uint8_t>(source[sourcePos]) < 0x80)
+				sourcePos = (sourcePos + 1) % source.size();
+
+			std::size_t next = sourcePos + 1;
+			while (next < source.size() && (static_cast<uint8_t>(source[next]) & 0xC0) == 0x80)
+				next++;
+
+			str.append(source, sourcePos, next - sourcePos);
+			sourcePos = next % source.size();
+		}
+
+		strings.push_back(std::move(str));
+	}
+
+	return strings;
+}
+
+//
+// The conversions with a byte by byte ASCII path, the reference the runs are measured against
+//
+static std::size_t cp932ToUtf8Scalar(const char* pSrc, const std::size_t& size, char* pDst)
+{
+	char* pOut = pDst;
+
+	for (std::size_t i = 0; i < size;)
+	{
+		const uint8_t b = static_cast<uint8_t>(pSrc[i]);
+
+		if (b < 0x80)
+		{
+			*pOut++ = pSrc[i++];
+			continue;
+		}
+
+		// A lead byte is passed on with the next byte, which is converted on its own if it is no trail byte
+		const std::size_t length = (CP932_LEAD_ROWS[b] != CP932_NO_LEAD && i + 1 < size) ? 2 : 1;
+		pOut += Cp932Transcoder::ToUtf8(pSrc + i, length, pOut);
+		i += length;
+	}
+
+	return static_cast<std::size_t>(pOut - pDst);
+}
+
+static std::size_t utf8ToUtf16Scalar(const char* pSrc, const std::size_t& size, char16_t* pDst)
+{
+	const uint8_t* pIn = reinterpret_cast<const uint8_t*>(pSrc);
+	char16_t* pOut     = pDst;
+
+	for (std::size_t i = 0; i < size;)
+	{
+		if (pIn[i] < 0x80)
+		{
+			*pOut++ = pIn[i++];
+			continue;
+		}
+
+		uint32_t c = 0;
+		i += Utf8::Read(pIn + i, size - i, c);
+
+		if (c == 0)
+			*pOut++ = Utf16Transcoder::REPLACEMENT_CHAR;
+		else if (c < 0x10000)
+			*pOut++ = static_cast<char16_t>(c);
+		else
+		{
+			c -= 0x10000;
+			*pOut++ = static_cast<char16_t>(0xD800 + (c >> 10));
+			*pOut++ = static_cast<char16_t>(0xDC00 + (c & 0x3FF));
+		}
+	}
+
+	return static_cast<std::size_t>(pOut - pDst);
+}
+
+//
+// The ASCII runs of the transcoders against a byte by byte loop on corpora with a growing
+// share of ASCII. Runs shorter than 16 bytes never reach the vector code, so this shows
+// what the check costs on short mixed runs as well as what it gains on long ones.
+//
+// Usage: AsciiRunBench [string count]
+//
+int main(int argc, char* argv[])
+{
+	const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 50000;
+
+	std::printf("%-8s %8s %10s | %-22s | %-22s\n", "", "", "", "CP932 -> UTF-8 MB/s", "UTF-8 -> UTF-16 MB/s");
+	std::printf("%-8s %8s %10s | %10s %10s | %10s %10s\n", "pieces", "bytes", "avg run", "runs", "scalar", "runs", "scalar");
+
+	for (const double share : { 0.0, 0.25, 0.5, 0.75, 0.95, 1.0 })
+	{
+		const std::vector<std::string> utf8Strings  = makeMixedStrings(count, share, 1);
+		const std::vector<std::string> cp932Strings = toCp932(utf8Strings);
+
+		std::size_t cp932Bytes = 0;
+		std::size_t utf8Bytes  = 0;
+		std::size_t asciiBytes = 0;
+		std::size_t runs       = 0;
+
+		for (std::size_t i = 0; i < count; i++)
+		{
+			cp932Bytes += cp932Strings[i].size();
+			utf8Bytes += utf8Strings[i].size();
+
+			bool inRun = false;
+			for (const char ch : utf8Strings[i])
+			{
+				const bool ascii = static_cast<uint8_t>(ch) < 0x80;
+				asciiBytes += ascii ? 1 : 0;
+				runs += (ascii && !inRun) ? 1 : 0;
+				inRun = ascii;
+			}
+		}
+
+		ScratchBuffer<char> utf8Buffer;
+		ScratchBuffer<char16_t> utf16Buffer;
+
+		// Both paths have to agree before their speed means anything
+		for (std::size_t i = 0; i < count; i++)
+		{
+			const std::string& cp932 = cp932Strings[i];
+			const std::string& utf8  = utf8Strings[i];
+
+			char* pDst             = utf8Buffer.Reserve(Cp932Transcoder::MaxUtf8Size(cp932.size()));
+			const std::size_t size = cp932ToUtf8Scalar(cp932.data(), cp932.size(), pDst);
+			char16_t* pWide        = utf16Buffer.Reserve(Utf16Transcoder::MaxUtf16Size(utf8.size()));
+			const std::size_t wide = utf8ToUtf16Scalar(utf8.data(), utf8.size(), pWide);
+
+			if (std::string_view(pDst, size) != Cp932Transcoder::ToUtf8(cp932) || std::u16string_view(pWide, wide) != Utf16Transcoder::FromUtf8(utf8))
+			{
+				std::printf("The scalar conversion of string %zu differs\n", i);
+				return 1;
+			}
+		}
+
+		const auto mbPerSecond = [&](const std::size_t& bytes, const double& ns) { return static_cast<double>(bytes) / static_cast<double>(count) / ns * 1e3; };
+
+		const double cp932Runs = measureNs(
+			[&](const std::size_t& i) {
+				const std::string& str = cp932Strings[i];
+				keepValue(Cp932Transcoder::ToUtf8(str.data(), str.size(), utf8Buffer.Reserve(Cp932Transcoder::MaxUtf8Size(str.size()))));
+			},
+			count);
+		const double cp932Scalar = measureNs(
+			[&](const std::size_t& i) {
+				const std::string& str = cp932Strings[i];
+				keepValue(cp932ToUtf8Scalar(str.data(), str.size(), utf8Buffer.Reserve(Cp932Transcoder::MaxUtf8Size(str.size()))));
+			},
+			count);
+		const double utf16Runs = measureNs(
+			[&](const std::size_t& i) {
+				const std::string& str = utf8Strings[i];
+				keepValue(Utf16Transcoder::FromUtf8(str.data(), str.size(), utf16Buffer.Reserve(Utf16Transcoder::MaxUtf16Size(str.size()))));
+			},
+			count);
+		const double utf16Scalar = measureNs(
+			[&](const std::size_t& i) {
+				const std::string& str = utf8Strings[i];
+				keepValue(utf8ToUtf16Scalar(str.data(), str.size(), utf16Buffer.Reserve(Utf16Transcoder::MaxUtf16Size(str.size()))));
+			},
+			count);
+
+		std::printf("%6.0f%%  %7.0f%% %10.1f | %10.1f %10.1f | %10.1f %10.1f\n", share * 100.0, 100.0 * static_cast<double>(asciiBytes) / static_cast<double>(utf8Bytes),
+					runs ? static_cast<double>(asciiBytes) / static_cast<double>(runs) : 0.0, mbPerSecond(cp932Bytes, cp932Runs), mbPerSecond(cp932Bytes, cp932Scalar),
+					mbPerSecond(utf8Bytes, utf16Runs), mbPerSecond(utf8Bytes, utf16Scalar));
+	}
+
+	return 0;
+}
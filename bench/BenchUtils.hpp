@@ -0,0 +1,139 @@
+/*
+ *  File: BenchUtils.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Common/Cp932Transcoder.hpp"
+
+inline volatile uint64_t g_benchSink = 0;
+
+//
+// Keep the compiler from dropping a computation whose result is otherwise unused
+//
+template<typename T>
+void keepValue(const T& value)
+{
+	g_benchSink = static_cast<uint64_t>(value);
+}
+
+//
+// Run the function repeatedly for at least the given time and return the average
+// nanoseconds per call. The function receives the index of the call.
+//
+template<typename Func>
+double measureNs(const Func& func, const std::size_t& callsPerRound, const double& minSeconds = 0.2)
+{
+	using Clock = std::chrono::steady_clock;
+
+	std::size_t calls             = 0;
+	const Clock::time_point start = Clock::now();
+	double elapsed                = 0.0;
+
+	do
+	{
+		for (std::size_t i = 0; i < callsPerRound; i++)
+			func(i);
+
+		calls += callsPerRound;
+		elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+	} while (elapsed < minSeconds);
+
+	return elapsed * 1e9 / static_cast<double>(calls);
+}
+
+//
+// Generated game like strings as UTF-8, e.g. menu texts and messages made of hiragana,
+// katakana, kanji and some ASCII. The same seed always gives the same strings.
+//
+inline std::vector<std::string> makeJapaneseStrings(const std::size_t& count, const uint32_t& seed = 1)
+{
+	static const char* const PIECES[] = { "の", "を", "に", "は", "が", "た", "し", "て", "ア", "イ", "ス", "ト", "ラ", "ン", "ド", "ー",
+										  "攻", "撃", "力", "魔", "法", "回", "復", "装", "備", "道", "具", "敵", "味", "方", "「", "」",
+										  "。", "、", "！", "？", "HP", "MP", "Lv", " " };
+	static constexpr std::size_t PIECE_COUNT = sizeof(PIECES) / sizeof(PIECES[0]);
+
+	std::mt19937 rng(seed);
+	std::uniform_int_distribution<std::size_t> lengthDist(2, 24);
+	std::uniform_int_distribution<std::size_t> pieceDist(0, PIECE_COUNT - 1);
+
+	std::vector<std::string> strings;
+	strings.reserve(count);
+
+	for (std::size_t i = 0; i < count; i++)
+	{
+		std::string str;
+		const std::size_t length = lengthDist(rng);
+		for (std::size_t j = 0; j < length; j++)
+			str += PIECES[pieceDist(rng)];
+
+		// Keeps the strings unique without changing their character mix much
+		str += std::to_string(i);
+		strings.push_back(std::move(str));
+	}
+
+	return strings;
+}
+
+inline std::vector<std::string> toCp932(const std::vector<std::string>& utf8Strings)
+{
+	std::vector<std::string> strings;
+	strings.reserve(utf8Strings.size());
+
+	for (const std::string& str : utf8Strings)
+		strings.push_back(Cp932Transcoder::FromUtf8(str));
+
+	return strings;
+}
+
+//
+// Bytes with roughly the distribution of x64 code, many REX prefixes, movs, calls, zero
+// and padding bytes, so scanners see as many candidate positions as in a real image
+//
+inline std::vector<uint8_t> makeCodeLikeData(const std::size_t& size, const uint32_t& seed = 1)
+{
+	static const uint8_t COMMON_BYTES[] = { 0x00, 0x00, 0x00, 0x48, 0x48, 0x89, 0x8B, 0xFF, 0xCC, 0xE8, 0x24, 0x4C, 0x83, 0x8D, 0x44, 0x0F,
+											0x85, 0xC0, 0x74, 0xEB, 0x41, 0x45, 0x33, 0xC3, 0x5C, 0x10, 0x20, 0x08, 0x01, 0x4D, 0x49, 0x90 };
+	static constexpr std::size_t COMMON_COUNT = sizeof(COMMON_BYTES) / sizeof(COMMON_BYTES[0]);
+
+	std::mt19937 rng(seed);
+	std::vector<uint8_t> data(size);
+
+	for (uint8_t& byte : data)
+	{
+		const uint32_t value = rng();
+		byte                 = (value & 1) ? COMMON_BYTES[(value >> 1) % COMMON_COUNT] : static_cast<uint8_t>(value >> 8);
+	}
+
+	return data;
+}
@@ -0,0 +1,107 @@
+/*
+ *  File: CatalogueSizeBench.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "../Common/TranslationBundle.hpp"
+#include "BenchUtils.hpp"
+
+//
+// Lookup cost over the catalogue size, comparing the std::map backed json object the
+// translations used to be stored in against the minimal perfect hash of the bundle.
+// Both are queried with the same key bytes in random order, so only the index differs.
+//
+// Usage: CatalogueSizeBench [largest size, default 1000000]
+//
+int main(int argc, char* argv[])
+{
+	const std::size_t maxCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+	std::printf("%10s %12s %12s %12s %12s %12s\n", "keys", "dom hit", "dom miss", "mph hit", "mph miss", "mph build");
+
+	for (std::size_t count = 1000; count <= maxCount; count *= 10)
+	{
+		const std::vector<std::string> keys   = makeJapaneseStrings(count, 1);
+		const std::vector<std::string> misses = makeJapaneseStrings(count, 2);
+
+		nlohmann::json dom = nlohmann::json::object();
+		TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+
+		for (const std::string& key : keys)
+		{
+			dom[key] = "text";
+			builder.Add(key, "text", u"");
+		}
+
+		const std::chrono::steady_clock::time_point buildStart = std::chrono::steady_clock::now();
+
+		TranslationBundle bundle;
+		if (!bundle.Load(builder.Build()))
+		{
+			std::printf("Building the bundle of %zu keys failed\n", count);
+			return 1;
+		}
+
+		const double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+
+		// Random order, so large catalogues do not profit from walking memory linearly
+		std::vector<std::size_t> order(count);
+		for (std::size_t i = 0; i < count; i++)
+			order[i] = i;
+
+		std::shuffle(order.begin(), order.end(), std::mt19937(3));
+
+		const auto domLookup = [&](const std::vector<std::string>& queries) {
+			return measureNs([&](const std::size_t& i) { keepValue(dom.find(queries[order[i]]) != dom.end()); }, count);
+		};
+
+		const auto bundleLookup = [&](const std::vector<std::string>& queries) {
+			const auto find = [&](const std::size_t& i) {
+				const std::string& query = queries[order[i]];
+				keepValue(static_cast<bool>(bundle.Find(query.data(), query.size())));
+			};
+
+			return measureNs(find, count);
+		};
+
+		const double domHit  = domLookup(keys);
+		const double domMiss = domLookup(misses);
+		const double mphHit  = bundleLookup(keys);
+		const double mphMiss = bundleLookup(misses);
+
+		std::printf("%10zu %9.1f ns %9.1f ns %9.1f ns %9.1f ns %9.0f ms\n", count, domHit, domMiss, mphHit, mphMiss, buildMs);
+	}
+
+	return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ *  File: Cp932TranscodeBench.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifdef __GLIBC__
+#include <iconv.h>
+#endif
+
+#include "../Common/Cp932Transcoder.hpp"
+#include "../Common/ScratchBuffer.hpp"
+#include "BenchUtils.hpp"
+
+#ifdef __GLIBC__
+//
+// Stand in for the Win32 conversions, either straight between the code pages or through
+// UTF-16 like the MultiByteToWideChar / WideCharToMultiByte pair the hooks used to call
+//
+class IconvConverter
+{
+public:
+	IconvConverter(const char* pTo, const char* pFrom, const char* pVia = nullptr) :
+		m_first(iconv_open(pVia ? pVia : pTo, pFrom)),
+		m_second(pVia ? iconv_open(pTo, pVia) : reinterpret_cast<iconv_t>(-1))
+	{
+	}
+
+	~IconvConverter()
+	{
+		if (m_first != reinterpret_cast<iconv_t>(-1))
+			iconv_close(m_first);
+		if (m_second != reinterpret_cast<iconv_t>(-1))
+			iconv_close(m_second);
+	}
+
+	IconvConverter(const IconvConverter&)            = delete;
+	IconvConverter& operator=(const IconvConverter&) = delete;
+
+	bool IsValid() const
+	{
+		return m_first != reinterpret_cast<iconv_t>(-1);
+	}
+
+	std::size_t Convert(const std::string& str)
+	{
+		const std::size_t size = convert(m_first, str.data(), str.size(), m_intermediate);
+		if (m_second == reinterpret_cast<iconv_t>(-1))
+			return size;
+
+		return convert(m_second, m_intermediate.data(), size, m_output);
+	}
+
+private:
+	static std::size_t convert(iconv_t cd, const char* pIn, std::size_t inSize, std::vector<char>& out)
+	{
+		if (out.size() < inSize * 4 + 4)
+			out.resize(inSize * 4 + 4);
+
+		char* pSrc         = const_cast<char*>(pIn);
+		char* pDst         = out.data();
+		std::size_t outLeft = out.size();
+
+		iconv(cd, nullptr, nullptr, nullptr, nullptr);
+		iconv(cd, &pSrc, &inSize, &pDst, &outLeft);
+
+		return out.size() - outLeft;
+	}
+
+private:
+	iconv_t m_first;
+	iconv_t m_second;
+	std::vector<char> m_intermediate;
+	std::vector<char> m_output;
+};
+#endif
+
+//
+// Throughput of the CP932 <-> UTF-8 conversions on game like strings, the way the hooks
+// call them, one string at a time. On glibc iconv is measured as the reference, both
+// directly and through UTF-16.
+//
+// Usage: Cp932TranscodeBench [string count]
+//
+int main(int argc, char* argv[])
+{
+	const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+
+	const std::vector<std::string> utf8Strings  = makeJapaneseStrings(count, 1);
+	const std::vector<std::string> cp932Strings = toCp932(utf8Strings);
+
+	std::size_t utf8Bytes  = 0;
+	std::size_t cp932Bytes = 0;
+	for (std::size_t i = 0; i < count; i++)
+	{
+		utf8Bytes += utf8Strings[i].size();
+		cp932Bytes += cp932Strings[i].size();
+	}
+
+	std::printf("%zu strings, %.1f MB CP932, %.1f MB UTF-8\n", count, cp932Bytes / 1e6, utf8Bytes / 1e6);
+	std::printf("%-28s %10s %10s\n", "", "ns/string", "MB/s");
+
+	// MB/s are counted on the input bytes
+	const auto run = [&](const char* pName, const std::vector<std::string>& input, const std::size_t& inputBytes, const auto& convert) {
+		const double ns = measureNs([&](const std::size_t& i) { keepValue(convert(input[i])); }, input.size());
+		std::printf("%-28s %10.1f %10.1f\n", pName, ns, static_cast<double>(inputBytes) / static_cast<double>(input.size()) / ns * 1e3);
+	};
+
+	ScratchBuffer<char> scratch;
+
+	run("ToUtf8 scratch buffer", cp932Strings, cp932Bytes, [&](const std::string& str) { return Cp932Transcoder::ToUtf8(str, scratch).size(); });
+	run("ToUtf8 std::string", cp932Strings, cp932Bytes, [&](const std::string& str) { return Cp932Transcoder::ToUtf8(str).size(); });
+
+#ifdef __GLIBC__
+	IconvConverter toUtf8("UTF-8", "CP932");
+	IconvConverter toUtf8Wide("UTF-8", "CP932", "UTF-16LE");
+	if (toUtf8.IsValid() && toUtf8Wide.IsValid())
+	{
+		run("ToUtf8 iconv", cp932Strings, cp932Bytes, [&](const std::string& str) { return toUtf8.Convert(str); });
+		run("ToUtf8 iconv via UTF-16", cp932Strings, cp932Bytes, [&](const std::string& str) { return toUtf8Wide.Convert(str); });
+	}
+#endif
+
+	run("FromUtf8 scratch buffer", utf8Strings, utf8Bytes, [&](const std::string& str) { return Cp932Transcoder::FromUtf8(str, scratch).size(); });
+	run("FromUtf8 std::string", utf8Strings, utf8Bytes, [&](const std::string& str) { return Cp932Transcoder::FromUtf8(str).size(); });
+
+#ifdef __GLIBC__
+	IconvConverter fromUtf8("CP932", "UTF-8");
+	IconvConverter fromUtf8Wide("CP932", "UTF-8", "UTF-16LE");
+	if (fromUtf8.IsValid() && fromUtf8Wide.IsValid())
+	{
+		run("FromUtf8 iconv", utf8Strings, utf8Bytes, [&](const std::string& str) { return fromUtf8.Convert(str); });
+		run("FromUtf8 iconv via UTF-16", utf8Strings, utf8Bytes, [&](const std::string& str) { return fromUtf8Wide.Convert(str); });
+	}
+#endif
+
+	return 0;
+}
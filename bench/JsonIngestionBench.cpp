@@ -0,0 +1,188 @@
+/*
+ *  File: JsonIngestionBench.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "../Common/Cp932Transcoder.hpp"
+#include "../Common/TranslationBundle.hpp"
+#include "../Common/TranslationCompiler.hpp"
+#include "BenchUtils.hpp"
+
+#ifdef __linux__
+#include <malloc.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//
+// Parse time and memory of loading a large tr.json, once into the nlohmann::json DOM
+// the DLLs used to keep alive and once streamed through the SAX handler into a bundle.
+// Every loader runs in a process of its own, so the peak RSS reported by wait4 only
+// covers that loader. The retained memory is the resident size after loading minus
+// the resident size before, with the loaded translations still alive.
+//
+// Usage: JsonIngestionBench [tr.json] [size in MB of the generated file]
+//
+
+static std::size_t getResidentBytes()
+{
+	// Freed heap memory is kept by the allocator otherwise and would count as retained
+	malloc_trim(0);
+
+	std::ifstream statm("/proc/self/statm");
+	std::size_t totalPages    = 0;
+	std::size_t residentPages = 0;
+	statm >> totalPages >> residentPages;
+
+	return residentPages * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+
+// A catalogue like the game's, roughly the given size in bytes
+static void writeCatalogue(const std::filesystem::path& path, const std::size_t& targetSize)
+{
+	std::ofstream out(path, std::ios::binary);
+	out << "{\n";
+
+	std::size_t written = 0;
+	uint32_t seed       = 1;
+
+	while (written < targetSize)
+	{
+		const std::vector<std::string> keys = makeJapaneseStrings(10000, seed++);
+
+		for (const std::string& key : keys)
+		{
+			std::string entry = "\t";
+			entry += nlohmann::json(key).dump();
+			entry += ": { \"text\": ";
+			entry += nlohmann::json("The translation of " + key).dump();
+			entry += ", \"pixel_lengths\": [" + std::to_string(key.size() * 7) + ", " + std::to_string(key.size() * 3) + "] },\n";
+
+			out << entry;
+			written += entry.size();
+		}
+	}
+
+	out << "\t\"window_title\": \"ETERNAL ROMANCE\"\n}\n";
+}
+
+static void loadDom(const std::filesystem::path& path)
+{
+	const std::size_t residentBefore = getResidentBytes();
+	const auto start                 = std::chrono::steady_clock::now();
+
+	std::ifstream input(path);
+	const nlohmann::json dom = nlohmann::json::parse(input);
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::printf("  %-6s parse %8.2f s, entries %9zu, retained %8.1f MB", "dom", seconds, dom.size(), static_cast<double>(getResidentBytes() - residentBefore) / (1024.0 * 1024.0));
+}
+
+static void loadSax(const std::filesystem::path& path)
+{
+	const std::size_t residentBefore = getResidentBytes();
+	const auto start                 = std::chrono::steady_clock::now();
+
+	TranslationEncoders encoders;
+	encoders.toSjis = [](const std::string& utf8) { return Cp932Transcoder::FromUtf8(utf8); };
+
+	TranslationBundle bundle;
+	{
+		std::ifstream input(path);
+		TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+		compileEternalTranslations(input, builder, encoders);
+		bundle.Load(builder.Build());
+	}
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::printf("  %-6s parse %8.2f s, entries %9zu, retained %8.1f MB", "sax", seconds, bundle.Size(), static_cast<double>(getResidentBytes() - residentBefore) / (1024.0 * 1024.0));
+}
+
+// Run the loader in a child process and append its peak resident size
+static void runIsolated(void (*pLoader)(const std::filesystem::path&), const std::filesystem::path& path)
+{
+	std::fflush(stdout);
+
+	const pid_t pid = fork();
+	if (pid == 0)
+	{
+		pLoader(path);
+		std::fflush(stdout);
+		_exit(0);
+	}
+
+	int status = 0;
+	struct rusage usage = {};
+	if (pid < 0 || wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+	{
+		std::printf("  loader failed\n");
+		return;
+	}
+
+	// ru_maxrss is in kilobytes on Linux
+	std::printf(", peak RSS %8.1f MB\n", static_cast<double>(usage.ru_maxrss) / 1024.0);
+}
+
+int main(int argc, char* argv[])
+{
+	const std::size_t sizeMb = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 50;
+
+	std::filesystem::path path;
+	bool generated = false;
+
+	if (argc > 1 && std::string(argv[1]) != "-")
+		path = argv[1];
+	else
+	{
+		path      = std::filesystem::temp_directory_path() / "JsonIngestionBench.json";
+		generated = true;
+		writeCatalogue(path, sizeMb * 1024 * 1024);
+	}
+
+	std::printf("Loading %s, %.1f MB\n", path.string().c_str(), static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0));
+
+	runIsolated(loadDom, path);
+	runIsolated(loadSax, path);
+
+	if (generated)
+		std::filesystem::remove(path);
+
+	return 0;
+}
+#else
+int main()
+{
+	std::printf("JsonIngestionBench measures the peak RSS of child processes and only runs on Linux\n");
+	return 0;
+}
+#endif
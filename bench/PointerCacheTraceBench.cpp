@@ -0,0 +1,142 @@
+/*
+ *  File: PointerCacheTraceBench.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../Common/Cp932Transcoder.hpp"
+#include "../Common/TranslationBundle.hpp"
+#include "../Common/TranslationPointerCache.hpp"
+#include "BenchUtils.hpp"
+
+//
+// Replays a trace of the strings handed to Mine_CopyFunc and reports the hit rate of
+// the pointer cache and the latency per call with and without it.
+//
+// The trace is a UTF-8 text file with one string per call. Identical strings are given
+// the same address, like constant strings in the read-only data of the game. Every
+// other string of the trace is treated as translated. Without a trace a synthetic one
+// is used: a frame draws 200 strings picked from 2000 with a Zipf like distribution.
+//
+// Usage: PointerCacheTraceBench [trace file]
+//
+static std::vector<std::string> makeTrace()
+{
+	static constexpr std::size_t STRING_COUNT = 2000;
+	static constexpr std::size_t CALL_COUNT   = 200 * 600;
+
+	const std::vector<std::string> strings = makeJapaneseStrings(STRING_COUNT, 5);
+
+	std::vector<double> weights(STRING_COUNT);
+	for (std::size_t i = 0; i < STRING_COUNT; i++)
+		weights[i] = 1.0 / static_cast<double>(i + 1);
+
+	std::mt19937 rng(7);
+	std::discrete_distribution<std::size_t> pick(weights.begin(), weights.end());
+
+	std::vector<std::string> trace;
+	trace.reserve(CALL_COUNT);
+	for (std::size_t i = 0; i < CALL_COUNT; i++)
+		trace.push_back(strings[pick(rng)]);
+
+	return trace;
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> trace;
+
+	if (argc > 1)
+	{
+		std::ifstream input(argv[1]);
+		if (!input.is_open())
+		{
+			std::printf("Unable to open %s\n", argv[1]);
+			return 1;
+		}
+
+		std::string line;
+		while (std::getline(input, line))
+			trace.push_back(line);
+	}
+	else
+		trace = makeTrace();
+
+	if (trace.empty())
+	{
+		std::printf("The trace is empty\n");
+		return 1;
+	}
+
+	// Store every distinct string once, so repeated calls see the same address
+	std::unordered_map<std::string, std::size_t> indices;
+	std::vector<std::string> constants;
+	std::vector<std::size_t> calls;
+
+	for (const std::string& str : trace)
+	{
+		const auto [it, inserted] = indices.emplace(str, constants.size());
+		if (inserted)
+			constants.push_back(Cp932Transcoder::FromUtf8(str));
+
+		calls.push_back(it->second);
+	}
+
+	TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+	for (std::size_t i = 0; i < constants.size(); i += 2)
+		builder.Add(constants[i], "Translated", u"", { 100 });
+
+	TranslationBundle bundle;
+	if (!bundle.Load(builder.Build()))
+	{
+		std::printf("Building the bundle failed\n");
+		return 1;
+	}
+
+	std::unique_ptr<TranslationPointerCache> pCache = std::make_unique<TranslationPointerCache>();
+
+	// Every lookup reaching the bundle is a cache miss, the bundle counts them in this build
+	for (const std::size_t& call : calls)
+		keepValue(static_cast<bool>(pCache->Find(bundle, constants[call].c_str())));
+
+	const BundleLookupStats stats = bundle.GetLookupStats();
+	const double hitRate          = 1.0 - static_cast<double>(stats.lookups) / static_cast<double>(calls.size());
+
+	const double cachedNs = measureNs([&](const std::size_t& i) { keepValue(static_cast<bool>(pCache->Find(bundle, constants[calls[i]].c_str()))); }, calls.size());
+	const double directNs = measureNs([&](const std::size_t& i) { keepValue(static_cast<bool>(bundle.Find(constants[calls[i]].c_str()))); }, calls.size());
+
+	std::printf("Calls: %zu, distinct strings: %zu, translated: %zu\n", calls.size(), constants.size(), bundle.Size());
+	std::printf("Pointer cache hit rate: %.2f%%\n", hitRate * 100.0);
+	std::printf("%-16s %8.1f ns/call\n", "Pointer cache", cachedNs);
+	std::printf("%-16s %8.1f ns/call\n", "Bundle lookup", directNs);
+
+	return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ *  File: RawKeyLookupBench.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "../Common/Cp932Transcoder.hpp"
+#include "../Common/TranslationBundle.hpp"
+#include "BenchUtils.hpp"
+
+//
+// Lookup of the CP932 strings the EternalRedirect hooks receive. The old path converted
+// every string to UTF-8 and looked it up in the tr.json DOM, the bundle is probed with
+// the raw bytes. The Win32 conversion is replaced by the portable transcoder here,
+// which is faster than the two MultiByteToWideChar / WideCharToMultiByte calls.
+//
+// Usage: RawKeyLookupBench [catalogue size]
+//
+int main(int argc, char* argv[])
+{
+	const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000;
+
+	const std::vector<std::string> keys = makeJapaneseStrings(count, 1);
+
+	nlohmann::json dom = nlohmann::json::object();
+	TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+
+	for (const std::string& key : keys)
+	{
+		dom[key] = { { "text", "Translated " + key }, { "pixel_lengths", { 100 } } };
+		builder.Add(Cp932Transcoder::FromUtf8(key), "Translated", u"", { 100 });
+	}
+
+	TranslationBundle bundle;
+	if (!bundle.Load(builder.Build()))
+	{
+		std::printf("Building the bundle failed\n");
+		return 1;
+	}
+
+	// Most drawn strings are untranslated, e.g. numbers, counters and names
+	std::vector<std::string> misses = toCp932(makeJapaneseStrings(count, 2));
+	for (std::size_t i = 0; i < count; i++)
+	{
+		if (i % 3 == 0)
+			misses[i] = std::to_string(i * 7);
+		else if (i % 3 == 1)
+			misses[i] = "HP " + std::to_string(i % 999) + "/999";
+	}
+
+	const std::vector<std::string> hits = toCp932(keys);
+
+	std::printf("Catalogue of %zu keys\n", count);
+	std::printf("%-26s %10s %10s\n", "", "hit ns", "miss ns");
+
+	const auto run = [&](const char* pName, const auto& lookup) {
+		const double hitNs  = measureNs([&](const std::size_t& i) { keepValue(lookup(hits[i])); }, hits.size());
+		const double missNs = measureNs([&](const std::size_t& i) { keepValue(lookup(misses[i])); }, misses.size());
+		std::printf("%-26s %10.1f %10.1f\n", pName, hitNs, missNs);
+	};
+
+	run("sjis2utf8 + json::contains", [&](const std::string& key) { return dom.contains(Cp932Transcoder::ToUtf8(key.c_str())); });
+	run("raw CP932 bundle lookup", [&](const std::string& key) { return static_cast<bool>(bundle.Find(key.c_str())); });
+
+	return 0;
+}
@@ -0,0 +1,157 @@
+/*
+ *  File: SignatureKernelBench.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "../Common/SignatureScanner.hpp"
+#include "../EternalRedirect/Signatures.hpp"
+#include "BenchUtils.hpp"
+
+//
+// Throughput of the scan kernels against the old nested byte loop. By default the
+// five EternalRedirect signatures are searched in a synthetic 32 MB image, about
+// the size of the game executable, with the signatures at its end. A real image can
+// be passed instead, e.g. the game executable, then all kernels have to agree on
+// wherever the signatures are found in it.
+//
+// Usage: SignatureKernelBench [image file]
+//
+
+// The loop of the old findFunction, extended by the wildcard masks
+static std::size_t findNaive(const uint8_t* pData, const std::size_t& size, const SignaturePattern& pattern)
+{
+	const std::vector<uint8_t>& bytes = pattern.GetBytes();
+	const std::vector<uint8_t>& mask  = pattern.GetMask();
+
+	for (std::size_t i = 0; i + bytes.size() <= size; i++)
+	{
+		std::size_t j = 0;
+		while (j < bytes.size() && (pData[i + j] & mask[j]) == bytes[j])
+			j++;
+
+		if (j == bytes.size())
+			return i;
+	}
+
+	return SignatureScanner::NOT_FOUND;
+}
+
+// Best time of a few runs in milliseconds
+template<typename Func>
+static double measureMs(const Func& func)
+{
+	double best = 1e30;
+
+	for (int run = 0; run < 5; run++)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		func();
+		best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return best;
+}
+
+static void printResult(const char* pName, const double& ms, const std::size_t& size)
+{
+	std::printf("  %-24s %9.2f ms %9.0f MB/s\n", pName, ms, static_cast<double>(size) / (1024.0 * 1024.0) / (ms / 1000.0));
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<uint8_t> image;
+	SignatureScanner scanner;
+
+	for (const FunctionSignature* pSignature : ETERNAL_SIGNATURES)
+		scanner.Add(pSignature->pattern);
+
+	if (argc > 1)
+	{
+		std::ifstream file(argv[1], std::ios::binary);
+		image.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+		if (image.empty())
+		{
+			std::printf("Failed to read %s\n", argv[1]);
+			return 1;
+		}
+	}
+	else
+	{
+		image = makeCodeLikeData(32 * 1024 * 1024, 1);
+
+		std::size_t offset = image.size() - 4096;
+		for (std::size_t i = 0; i < scanner.Size(); i++)
+		{
+			const SignaturePattern& pattern = scanner.GetPattern(i);
+			std::copy(pattern.GetBytes().begin(), pattern.GetBytes().end(), image.begin() + static_cast<std::ptrdiff_t>(offset));
+			offset += pattern.Size() + 64;
+		}
+	}
+
+	std::printf("Scanning %.1f MB for %zu signatures\n", static_cast<double>(image.size()) / (1024.0 * 1024.0), scanner.Size());
+
+	std::vector<std::size_t> expected(scanner.Size());
+	printResult("naive loop", measureMs([&]() {
+		for (std::size_t i = 0; i < scanner.Size(); i++)
+			expected[i] = findNaive(image.data(), image.size(), scanner.GetPattern(i));
+	}), image.size());
+
+	const struct
+	{
+		const char* pName;
+		ScanKernel kernel;
+		bool supported;
+	} kernels[] = {
+		{ "scalar", ScanKernel::Scalar, true },
+		{ "SSE2", ScanKernel::SSE2, CpuFeatures::Get().sse2 },
+		{ "AVX2", ScanKernel::AVX2, CpuFeatures::Get().avx2 },
+	};
+
+	for (const auto& kernel : kernels)
+	{
+		if (!kernel.supported)
+		{
+			std::printf("  %-24s not supported by this CPU\n", kernel.pName);
+			continue;
+		}
+
+		std::vector<std::size_t> offsets;
+		printResult(kernel.pName, measureMs([&]() { offsets = scanner.Scan(image.data(), image.size(), kernel.kernel); }), image.size());
+
+		if (offsets != expected)
+		{
+			std::printf("The %s kernel found different offsets\n", kernel.pName);
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,122 @@
+/*
+ *  File: SignatureScanBench.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../Common/SignatureScanner.hpp"
+#include "../EternalRedirect/Signatures.hpp"
+#include "BenchUtils.hpp"
+
+//
+// Startup scan of the five EternalRedirect signatures in a synthetic image. The old
+// SetupHook searched every pattern on its own with a nested byte loop, the scanner
+// finds all of them in one pass, optionally split over several threads. The
+// signatures are placed at the end of the image, so every approach reads all of it.
+//
+// Usage: SignatureScanBench [image size in MB]
+//
+
+// The loop of the old findFunction, extended by the wildcard masks
+static std::size_t findNaive(const uint8_t* pData, const std::size_t& size, const SignaturePattern& pattern)
+{
+	const std::vector<uint8_t>& bytes = pattern.GetBytes();
+	const std::vector<uint8_t>& mask  = pattern.GetMask();
+
+	for (std::size_t i = 0; i + bytes.size() <= size; i++)
+	{
+		std::size_t j = 0;
+		while (j < bytes.size() && (pData[i + j] & mask[j]) == bytes[j])
+			j++;
+
+		if (j == bytes.size())
+			return i;
+	}
+
+	return SignatureScanner::NOT_FOUND;
+}
+
+// Best time of a few runs in milliseconds
+template<typename Func>
+static double measureMs(const Func& func)
+{
+	double best = 1e30;
+
+	for (int run = 0; run < 3; run++)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		func();
+		best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return best;
+}
+
+int main(int argc, char* argv[])
+{
+	const std::size_t sizeMb = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100;
+	std::vector<uint8_t> image = makeCodeLikeData(sizeMb * 1024 * 1024, 1);
+
+	SignatureScanner scanner;
+	std::size_t offset = image.size() - 4096;
+
+	for (const FunctionSignature* pSignature : ETERNAL_SIGNATURES)
+	{
+		const SignaturePattern& pattern = pSignature->pattern;
+		for (std::size_t i = 0; i < pattern.Size(); i++)
+			image[offset + i] = pattern.GetBytes()[i];
+
+		scanner.Add(pattern);
+		offset += pattern.Size() + 64;
+	}
+
+	std::vector<std::size_t> naiveOffsets(scanner.Size());
+	std::vector<std::size_t> singleOffsets;
+	std::vector<std::size_t> parallelOffsets;
+
+	const double naiveMs = measureMs([&]() {
+		for (std::size_t i = 0; i < scanner.Size(); i++)
+			naiveOffsets[i] = findNaive(image.data(), image.size(), scanner.GetPattern(i));
+	});
+
+	const double singleMs   = measureMs([&]() { singleOffsets = scanner.Scan(image.data(), image.size()); });
+	const double parallelMs = measureMs([&]() { parallelOffsets = scanner.ScanParallel(image.data(), image.size()); });
+
+	if (singleOffsets != naiveOffsets || parallelOffsets != naiveOffsets)
+	{
+		std::printf("The scans found different offsets\n");
+		return 1;
+	}
+
+	std::printf("Scanning %zu MB for %zu signatures\n", sizeMb, scanner.Size());
+	std::printf("  %-28s %9.1f ms\n", "one naive scan per signature", naiveMs);
+	std::printf("  %-28s %9.1f ms\n", "single pass", singleMs);
+	std::printf("  %-28s %9.1f ms\n", "single pass, all cores", parallelMs);
+
+	return 0;
+}
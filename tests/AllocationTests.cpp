@@ -0,0 +1,235 @@
+/*
+ *  File: AllocationTests.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../Common/Cp932Transcoder.hpp"
+#include "../Common/PatternResultCache.hpp"
+#include "../Common/ScratchBuffer.hpp"
+#include "../Common/SnapshotReloader.hpp"
+#include "../Common/TranslationBundle.hpp"
+#include "../Common/TranslationPointerCache.hpp"
+#include "../Common/TranslationTemplates.hpp"
+#include "../Common/Utf16Transcoder.hpp"
+#include "TestUtils.hpp"
+
+//
+// Every allocation of the program goes through these, so a test can count the ones made
+// by the code it runs. Array and nothrow forms end up here by default.
+//
+static std::atomic<std::size_t> g_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+	g_allocations++;
+
+	if (void* p = std::malloc(size != 0 ? size : 1))
+		return p;
+
+	throw std::bad_alloc();
+}
+
+// GCC takes the inlined free() for a mismatch with operator new, which is replaced as well
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+//
+// Call the function once so that buffers and caches reach their size, then return the
+// allocations made by the following calls
+//
+template<typename Func>
+static std::size_t countAllocations(const Func& func, const std::size_t& calls = 10000)
+{
+	func(0);
+
+	const std::size_t before = g_allocations;
+	for (std::size_t i = 0; i < calls; i++)
+		func(i);
+
+	return g_allocations - before;
+}
+
+static const std::vector<std::string> UTF8_TEXTS = { "スライムが現れた！", "HP 120/999", "攻撃力が上がった。", "", "Lv.99 「勇者」",
+													  std::string(5000, 'a') + "魔法" };
+
+// The conversions into a scratch buffer do not allocate once the buffer fits the longest string
+static void testConversions()
+{
+	std::vector<std::string> cp932Texts;
+	std::vector<std::u16string> utf16Texts;
+	for (const std::string& text : UTF8_TEXTS)
+	{
+		cp932Texts.push_back(Cp932Transcoder::FromUtf8(text));
+		utf16Texts.push_back(Utf16Transcoder::FromUtf8(text));
+	}
+
+	ScratchBuffer<char> buffer;
+	ScratchBuffer<char16_t> wideBuffer;
+
+	const auto convertAll = [&](const std::size_t&) {
+		for (std::size_t i = 0; i < UTF8_TEXTS.size(); i++)
+		{
+			CHECK(Cp932Transcoder::ToUtf8(cp932Texts[i], buffer) == UTF8_TEXTS[i]);
+			CHECK(Cp932Transcoder::FromUtf8(UTF8_TEXTS[i], buffer) == cp932Texts[i]);
+			CHECK(Utf16Transcoder::FromUtf8(UTF8_TEXTS[i], wideBuffer) == utf16Texts[i]);
+			CHECK(Utf16Transcoder::ToUtf8(utf16Texts[i], buffer) == UTF8_TEXTS[i]);
+		}
+	};
+
+	CHECK(countAllocations(convertAll, 1000) == 0);
+
+	// The counter works, the string versions allocate on every call
+	CHECK(countAllocations([&](const std::size_t&) { CHECK(Cp932Transcoder::ToUtf8(cp932Texts[5]).size() == UTF8_TEXTS[5].size()); }, 100) >= 100);
+}
+
+// Formatting the way the DrawFormatString hooks do, measure first, then write into the buffer
+static std::string_view formatInto(ScratchBuffer<char>& buffer, const char* pFormat, ...)
+{
+	va_list args;
+	va_start(args, pFormat);
+
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	const int length = std::vsnprintf(nullptr, 0, pFormat, argsCopy);
+	va_end(argsCopy);
+
+	char* pBuffer = buffer.Reserve(static_cast<std::size_t>(length));
+	std::vsnprintf(pBuffer, static_cast<std::size_t>(length) + 1, pFormat, args);
+	va_end(args);
+
+	return buffer.Finish(static_cast<std::size_t>(length));
+}
+
+static void testFormatting()
+{
+	ScratchBuffer<char> buffer;
+
+	const auto format = [&](const std::size_t& i) {
+		CHECK(formatInto(buffer, "%s HP %zu/%d", "スライム", i % 1000, 999).size() >= 21);
+		CHECK(formatInto(buffer, "%s", UTF8_TEXTS[5].c_str()).size() == UTF8_TEXTS[5].size());
+	};
+
+	CHECK(countAllocations(format) == 0);
+	CHECK(formatInto(buffer, "%s HP %d/%d", "Slime", 12, 999) == "Slime HP 12/999");
+}
+
+// Lookups of hits and misses in the bundle and both caches, and taking the snapshot guard
+static void testLookups()
+{
+	TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+	builder.Add("Attack", "Angriff", u"");
+	builder.Add(Cp932Transcoder::FromUtf8("スライム"), "Schleim", u"");
+
+	TranslationBundle bundle;
+	CHECK(bundle.Load(builder.Build()));
+
+	const std::string slime                         = Cp932Transcoder::FromUtf8("スライム");
+	std::unique_ptr<TranslationPointerCache> pCache = std::make_unique<TranslationPointerCache>();
+
+	PatternResultCache patternResults(64);
+	CHECK(patternResults.Insert(u"スライムを倒した", u"Defeated Slime") != nullptr);
+	CHECK(patternResults.InsertNoMatch(u"HP 12/999") == &PatternResultCache::NO_MATCH);
+
+	SnapshotReloader<int> reloader;
+	reloader.Publish(std::make_unique<int>(1));
+
+	const auto lookup = [&](const std::size_t& i) {
+		CHECK(bundle.Find("Attack"));
+		CHECK(bundle.Find(slime.c_str()));
+		CHECK(!bundle.Find("Flee"));
+		CHECK(!bundle.Find(i % 2 ? "HP 12/999" : "12", i % 2 ? 9 : 2));
+
+		CHECK(pCache->Find(bundle, "Attack"));
+		CHECK(!pCache->Find(bundle, "Flee"));
+
+		CHECK(patternResults.Find(u"スライムを倒した") != nullptr);
+		CHECK(patternResults.Find(u"スライム") == nullptr);
+		CHECK(patternResults.Find(u"HP 12/999") == &PatternResultCache::NO_MATCH);
+
+		const SnapshotReloader<int>::ReadGuard guard = reloader.Read();
+		CHECK(guard && *guard.Get() == 1);
+	};
+
+	CHECK(countAllocations(lookup) == 0);
+}
+
+// Matching the patterns, including ones with two placeholders and a repeated inner literal
+static void testPatternMatching()
+{
+	TranslationBundleBuilder builder(BundleKeyEncoding::UTF16);
+	builder.AddTemplates({ { u"{}を倒した", u"Defeated {1}" }, { u"{0}と{0}の戦い", u"{1} against {1}" }, { u"{1} x {0}", u"{0} x {1}" } },
+						 { { u"スライム", u"Slime" }, { u"と", u"And" }, { u"ドラゴン", u"Dragon" } });
+
+	TranslationBundle bundle;
+	CHECK(bundle.Load(builder.Build()));
+
+	TranslationTemplates templates;
+	CHECK(templates.Attach(bundle));
+
+	std::u16string result;
+	const auto match = [&](const std::size_t& i) {
+		CHECK(templates.Find(i % 2 ? u"スライムを倒した" : u"ドラゴンを倒した", result));
+		CHECK(templates.Find(u"とととの戦い", result));
+		CHECK(templates.Find(u"Slime x スライム", result));
+		CHECK(!templates.Find(u"スライムとドラゴンの戦い", result));
+		CHECK(!templates.Find(u"HP 12/999", result));
+	};
+
+	CHECK(countAllocations(match) == 0);
+	CHECK(templates.Find(u"とととの戦い", result) && result == u"And against And");
+}
+
+int main()
+{
+	testConversions();
+	testFormatting();
+	testLookups();
+	testPatternMatching();
+
+	return finishTests("AllocationTests");
+}
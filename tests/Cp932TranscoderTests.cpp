@@ -0,0 +1,250 @@
+/*
+ *  File: Cp932TranscoderTests.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#include <cstdint>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../Common/Cp932Transcoder.hpp"
+#include "../Common/ScratchBuffer.hpp"
+#include "../Common/Utf8.hpp"
+#include "TestUtils.hpp"
+
+static std::string utf8Char(const uint32_t& c)
+{
+	char buffer[4];
+	char* pOut = buffer;
+	Utf8::Write(c, pOut);
+	return std::string(buffer, pOut);
+}
+
+static bool isLeadByte(const uint32_t& b)
+{
+	return (b >= 0x81 && b <= 0x9F) || (b >= 0xE0 && b <= 0xFC);
+}
+
+//
+// Every single byte and every lead and trail byte pair of the code page, including the
+// pairs without a character, which decode to DEFAULT_CHAR
+//
+static std::vector<std::string> allCodes()
+{
+	std::vector<std::string> codes;
+
+	for (uint32_t b = 0; b < 0x100; b++)
+	{
+		if (!isLeadByte(b))
+			codes.push_back(std::string(1, static_cast<char>(b)));
+	}
+
+	for (uint32_t lead = 0x81; lead <= 0xFC; lead++)
+	{
+		if (!isLeadByte(lead))
+			continue;
+
+		for (uint32_t trail = 0x40; trail <= 0xFC; trail++)
+		{
+			if (trail != 0x7F)
+				codes.push_back({ static_cast<char>(lead), static_cast<char>(trail) });
+		}
+	}
+
+	return codes;
+}
+
+//
+// Decoding any code and encoding the result again gives a code that decodes to the same
+// character. Codes with several encodings, like the NEC and IBM duplicates, come back as
+// their preferred code, so exactly one code per character round trips byte for byte.
+//
+static void testDecodeRoundTrip()
+{
+	const std::vector<std::string> codes = allCodes();
+	CHECK(codes.size() == 196 + 60 * 188);
+
+	std::set<std::string> characters;
+	std::size_t exact = 0;
+	bool allGood      = true;
+
+	for (const std::string& code : codes)
+	{
+		const std::string utf8 = Cp932Transcoder::ToUtf8(code);
+
+		uint32_t c = 0;
+		const bool single =
+			!utf8.empty() && (static_cast<uint8_t>(utf8[0]) < 0x80 ? utf8.size() == 1 : Utf8::Read(reinterpret_cast<const uint8_t*>(utf8.data()), utf8.size(), c) == utf8.size() && c != 0);
+
+		const std::string encoded = Cp932Transcoder::FromUtf8(utf8);
+		const bool good           = single && (encoded != "?" || code == "?") && Cp932Transcoder::ToUtf8(encoded) == utf8;
+
+		if (!good && allGood)
+			std::printf("  first bad code: %02X%02X\n", static_cast<uint8_t>(code[0]), code.size() > 1 ? static_cast<uint8_t>(code[1]) : 0);
+
+		allGood = allGood && good;
+		characters.insert(utf8);
+
+		if (encoded == code)
+			exact++;
+	}
+
+	CHECK(allGood);
+	CHECK(exact == characters.size());
+}
+
+//
+// Every BMP character that some code decodes to encodes to a code that decodes back to
+// it. The other characters give REPLACEMENT_CHAR, or another character from the best fit
+// list like WideCharToMultiByte does.
+//
+static void testEncodeRoundTrip()
+{
+	std::set<std::string> decoded;
+	for (const std::string& code : allCodes())
+		decoded.insert(Cp932Transcoder::ToUtf8(code));
+
+	std::set<uint32_t> bestFit;
+	for (const uint16_t* pBestFit : CP932_BEST_FIT)
+	{
+		if (decoded.count(utf8Char(pBestFit[0])) == 0)
+			bestFit.insert(pBestFit[0]);
+	}
+
+	std::size_t roundTrips = 0;
+	std::size_t bestFits   = 0;
+	bool allGood           = true;
+
+	for (uint32_t c = 0; c < 0x10000; c++)
+	{
+		if (c >= 0xD800 && c <= 0xDFFF)
+			continue;
+
+		const std::string utf8    = utf8Char(c);
+		const std::string encoded = Cp932Transcoder::FromUtf8(utf8);
+		const std::string back    = Cp932Transcoder::ToUtf8(encoded);
+
+		bool good = encoded.size() == 1 || encoded.size() == 2;
+
+		if (decoded.count(utf8) != 0)
+		{
+			good = good && back == utf8;
+			roundTrips++;
+		}
+		else if (bestFit.count(c) != 0)
+		{
+			good = good && encoded != "?" && back != utf8 && decoded.count(back) != 0;
+			bestFits++;
+		}
+		else
+			good = encoded == "?";
+
+		if (!good && allGood)
+			std::printf("  U+%04X encodes wrong\n", c);
+
+		allGood = allGood && good;
+	}
+
+	CHECK(allGood);
+	CHECK(roundTrips == decoded.size());
+	CHECK(bestFits == bestFit.size());
+}
+
+static void testKnownCodes()
+{
+	CHECK(Cp932Transcoder::ToUtf8("\x82\xA0") == "あ");
+	CHECK(Cp932Transcoder::ToUtf8("\x81\x40") == utf8Char(0x3000));
+	CHECK(Cp932Transcoder::ToUtf8("\xB1") == utf8Char(0xFF71));
+	CHECK(Cp932Transcoder::ToUtf8("\x87\x40") == utf8Char(0x2460));
+	CHECK(Cp932Transcoder::ToUtf8("\xF0\x40") == utf8Char(0xE000));
+	CHECK(Cp932Transcoder::ToUtf8("\xF9\xFC") == utf8Char(0xE757));
+
+	CHECK(Cp932Transcoder::FromUtf8("あ") == "\x82\xA0");
+	CHECK(Cp932Transcoder::FromUtf8(utf8Char(0xE000)) == "\xF0\x40");
+
+	// Duplicates encode to the code Windows prefers
+	CHECK(Cp932Transcoder::ToUtf8("\x87\x90") == utf8Char(0x2252));
+	CHECK(Cp932Transcoder::FromUtf8(utf8Char(0x2252)) == "\x81\xE0");
+	CHECK(Cp932Transcoder::ToUtf8("\xED\x40") == utf8Char(0x7E8A));
+	CHECK(Cp932Transcoder::FromUtf8(utf8Char(0x7E8A)) == "\xFA\x5C");
+}
+
+static void testBrokenInput()
+{
+	const std::string defaultChar = utf8Char(Cp932Transcoder::DEFAULT_CHAR);
+
+	// A lead byte at the end or without a valid trail byte, the next byte stays intact
+	CHECK(Cp932Transcoder::ToUtf8("\x82") == defaultChar);
+	CHECK(Cp932Transcoder::ToUtf8("a\x82 b") == "a" + defaultChar + " b");
+	CHECK(Cp932Transcoder::ToUtf8(std::string("\x82\x00", 2)) == defaultChar + std::string(1, '\0'));
+
+	// A pair without a character
+	CHECK(Cp932Transcoder::ToUtf8("\x85\x40") == defaultChar);
+
+	// Broken UTF-8 and characters outside the BMP
+	CHECK(Cp932Transcoder::FromUtf8("\xC3") == "?");
+	CHECK(Cp932Transcoder::FromUtf8("a\xE3\x81z") == "a?z");
+	CHECK(Cp932Transcoder::FromUtf8("\xED\xA0\x80") == "???");
+	CHECK(Cp932Transcoder::FromUtf8("\xF0\x9F\x98\x80") == "?");
+	CHECK(Cp932Transcoder::FromUtf8("") == "");
+	CHECK(Cp932Transcoder::ToUtf8("") == "");
+}
+
+//
+// The pointer, scratch buffer and string versions give the same result on the whole code
+// page at once, which also runs the ASCII fast path between the multibyte characters
+//
+static void testApisAgree()
+{
+	std::string cp932;
+	for (const std::string& code : allCodes())
+		cp932 += code + "ab";
+
+	const std::string utf8 = Cp932Transcoder::ToUtf8(cp932);
+
+	std::vector<char> buffer(Cp932Transcoder::MaxUtf8Size(cp932.size()));
+	const std::size_t utf8Size = Cp932Transcoder::ToUtf8(cp932.data(), cp932.size(), buffer.data());
+	CHECK(std::string(buffer.data(), utf8Size) == utf8);
+
+	ScratchBuffer<char> scratch;
+	const std::string_view utf8View = Cp932Transcoder::ToUtf8(cp932, scratch);
+	CHECK(utf8View == utf8);
+	CHECK(utf8View.data()[utf8View.size()] == '\0');
+
+	const std::string encoded = Cp932Transcoder::FromUtf8(utf8);
+	CHECK(encoded.size() <= Cp932Transcoder::MaxCp932Size(utf8.size()));
+	CHECK(Cp932Transcoder::FromUtf8(utf8, scratch) == encoded);
+	CHECK(Cp932Transcoder::ToUtf8(encoded) == utf8);
+}
+
+int main()
+{
+	testDecodeRoundTrip();
+	testEncodeRoundTrip();
+	testKnownCodes();
+	testBrokenInput();
+	testApisAgree();
+
+	return finishTests("Cp932TranscoderTests");
+}
@@ -0,0 +1,143 @@
+/*
+ *  File: PatternResultCacheTests.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Common/PatternResultCache.hpp"
+#include "TestUtils.hpp"
+
+static void testFindAndInsert()
+{
+	PatternResultCache cache(16);
+	CHECK(cache.Find(u"スライムを倒した") == nullptr);
+
+	const std::u16string* pResult = cache.Insert(u"スライムを倒した", u"Defeated Slime");
+	CHECK(pResult != nullptr && *pResult == u"Defeated Slime");
+	CHECK(cache.Find(u"スライムを倒した") == pResult);
+	CHECK(cache.Size() == 1);
+
+	// A key that is already cached keeps its first result
+	CHECK(cache.Insert(u"スライムを倒した", u"Other") == pResult);
+	CHECK(*pResult == u"Defeated Slime");
+	CHECK(cache.Size() == 1);
+
+	CHECK(cache.Find(u"スライム") == nullptr);
+	CHECK(cache.Find(u"") == nullptr);
+
+	// Results are null terminated for the game
+	CHECK(pResult->c_str()[pResult->size()] == u'\0');
+}
+
+static void testNoMatch()
+{
+	PatternResultCache cache(16);
+
+	// A miss is cached as NO_MATCH, which is no result of its own
+	CHECK(cache.InsertNoMatch(u"1234") == &PatternResultCache::NO_MATCH);
+	CHECK(cache.Find(u"1234") == &PatternResultCache::NO_MATCH);
+	CHECK(cache.Size() == 1);
+
+	CHECK(cache.InsertNoMatch(u"1234") == &PatternResultCache::NO_MATCH);
+	CHECK(cache.Insert(u"1234", u"Other") == &PatternResultCache::NO_MATCH);
+	CHECK(cache.Size() == 1);
+
+	// Results and misses do not affect each other
+	const std::u16string* pResult = cache.Insert(u"スライムを倒した", u"Defeated Slime");
+	CHECK(pResult != nullptr && pResult != &PatternResultCache::NO_MATCH);
+	CHECK(cache.InsertNoMatch(u"スライムを倒した") == pResult);
+	CHECK(cache.Find(u"スライムを倒した") == pResult);
+	CHECK(cache.Find(u"5678") == nullptr);
+}
+
+static void testFullCache()
+{
+	PatternResultCache cache(4);
+
+	std::size_t cached = 0;
+	for (int i = 0; i < 100; i++)
+	{
+		const std::u16string key = u"key" + std::u16string(1, static_cast<char16_t>(u'A' + i));
+		if (cache.Insert(key, key) != nullptr)
+			cached++;
+	}
+
+	// Only as many results as there are slots fit, the rest is not cached
+	CHECK(cached == 4);
+	CHECK(cache.Size() == 4);
+
+	for (int i = 0; i < 100; i++)
+	{
+		const std::u16string key      = u"key" + std::u16string(1, static_cast<char16_t>(u'A' + i));
+		const std::u16string* pResult = cache.Find(key);
+		CHECK(pResult == nullptr || *pResult == key);
+	}
+}
+
+static void testConcurrentInserts()
+{
+	PatternResultCache cache(1024);
+	std::vector<std::thread> threads;
+	std::atomic<int> mismatches = 0;
+
+	// All threads race to insert the same keys, every thread must end up with the same entries
+	std::vector<std::vector<const std::u16string*>> results(4);
+	for (std::size_t t = 0; t < results.size(); t++)
+	{
+		threads.emplace_back([&cache, &mismatches, &result = results[t]]() {
+			for (int i = 0; i < 500; i++)
+			{
+				const std::u16string key = u"Pattern " + std::u16string(1, static_cast<char16_t>(0x3041 + i));
+				const std::u16string* pResult = cache.Insert(key, key + u"!");
+
+				if (pResult == nullptr || *pResult != key + u"!" || cache.Find(key) != pResult)
+					mismatches++;
+
+				result.push_back(pResult);
+			}
+		});
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	CHECK(mismatches == 0);
+	CHECK(cache.Size() == 500);
+
+	for (std::size_t t = 1; t < results.size(); t++)
+		CHECK(results[t] == results[0]);
+}
+
+int main()
+{
+	testFindAndInsert();
+	testNoMatch();
+	testFullCache();
+	testConcurrentInserts();
+
+	return finishTests("PatternResultCacheTests");
+}
@@ -0,0 +1,375 @@
+/*
+ *  File: PeImageTests.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Common/ImageScanner.hpp"
+#include "../Common/ModuleUtils.hpp"
+#include "../Common/PeImage.hpp"
+#include "TestUtils.hpp"
+
+//
+// Synthetic PE images, built in memory instead of shipping binaries. Every image has
+// a code, a read-only data, a writable data and an uninitialized data section.
+//
+struct FixtureSection
+{
+	std::string name;
+	uint32_t characteristics;
+	std::vector<uint8_t> data;
+	uint32_t virtualSize;
+};
+
+static constexpr uint32_t SCN_CODE       = 0x00000020;
+static constexpr uint32_t SCN_IDATA      = 0x00000040;
+static constexpr uint32_t SCN_UDATA      = 0x00000080;
+static constexpr uint32_t SCN_MEM_EXEC   = 0x20000000;
+static constexpr uint32_t SCN_MEM_READ   = 0x40000000;
+static constexpr uint32_t SCN_MEM_WRITE  = 0x80000000;
+static constexpr uint32_t HEADERS_SIZE   = 0x400;
+static constexpr uint32_t FILE_ALIGNMENT = 0x200;
+static constexpr uint32_t SECTION_ALIGN  = 0x1000;
+static constexpr uint32_t TIME_STAMP     = 0x5F3759DF;
+static constexpr uint32_t CHECK_SUM      = 0x0012A5C3;
+
+template<typename T>
+static void put(std::vector<uint8_t>& data, const std::size_t& offset, const T& value)
+{
+	std::memcpy(data.data() + offset, &value, sizeof(T));
+}
+
+static uint32_t alignUp(const uint32_t& value, const uint32_t& alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+static std::vector<FixtureSection> makeSections()
+{
+	std::vector<uint8_t> code(0x300, 0xCC);
+	std::vector<uint8_t> rdata(0x80, 0);
+	std::vector<uint8_t> data(0x40, 0x11);
+
+	std::memcpy(rdata.data(), "Constant text", 14);
+
+	return {
+		{ ".text", SCN_CODE | SCN_MEM_EXEC | SCN_MEM_READ, code, 0x2F0 },
+		{ ".rdata", SCN_IDATA | SCN_MEM_READ, rdata, 0x80 },
+		{ ".data", SCN_IDATA | SCN_MEM_READ | SCN_MEM_WRITE, data, 0x1800 },
+		{ ".textbss", SCN_UDATA | SCN_MEM_READ | SCN_MEM_WRITE, {}, 0x100 },
+	};
+}
+
+static std::vector<uint8_t> buildPe(const bool& is64Bit, const PeLayout& layout, const std::vector<FixtureSection>& sections)
+{
+	static constexpr uint32_t NT_OFFSET = 0x80;
+
+	const uint16_t optionalSize = is64Bit ? 0xF0 : 0xE0;
+	const uint32_t fileHeader   = NT_OFFSET + 4;
+	const uint32_t optional     = fileHeader + 20;
+	const uint32_t sectionTable = optional + optionalSize;
+
+	// Place the sections like a linker would, at aligned file offsets and virtual addresses
+	std::vector<uint32_t> rvas;
+	std::vector<uint32_t> rawOffsets;
+	uint32_t rva       = SECTION_ALIGN;
+	uint32_t rawOffset = HEADERS_SIZE;
+
+	for (const FixtureSection& section : sections)
+	{
+		rvas.push_back(rva);
+		rawOffsets.push_back(section.data.empty() ? 0 : rawOffset);
+
+		rva += alignUp(std::max<uint32_t>(section.virtualSize, static_cast<uint32_t>(section.data.size())), SECTION_ALIGN);
+		rawOffset += alignUp(static_cast<uint32_t>(section.data.size()), FILE_ALIGNMENT);
+	}
+
+	const uint32_t sizeOfImage = rva;
+	std::vector<uint8_t> image(layout == PeLayout::Mapped ? sizeOfImage : rawOffset, 0);
+
+	put<uint16_t>(image, 0, 0x5A4D);
+	put<uint32_t>(image, 0x3C, NT_OFFSET);
+	put<uint32_t>(image, NT_OFFSET, 0x00004550);
+
+	put<uint16_t>(image, fileHeader, is64Bit ? 0x8664 : 0x014C);
+	put<uint16_t>(image, fileHeader + 2, static_cast<uint16_t>(sections.size()));
+	put<uint32_t>(image, fileHeader + 4, TIME_STAMP);
+	put<uint16_t>(image, fileHeader + 16, optionalSize);
+
+	put<uint16_t>(image, optional, is64Bit ? 0x20B : 0x10B);
+	if (is64Bit)
+		put<uint64_t>(image, optional + 24, 0x140000000ull);
+	else
+		put<uint32_t>(image, optional + 28, 0x00400000);
+
+	put<uint32_t>(image, optional + 32, SECTION_ALIGN);
+	put<uint32_t>(image, optional + 36, FILE_ALIGNMENT);
+	put<uint32_t>(image, optional + 56, sizeOfImage);
+	put<uint32_t>(image, optional + 60, HEADERS_SIZE);
+	put<uint32_t>(image, optional + 64, CHECK_SUM);
+
+	for (std::size_t i = 0; i < sections.size(); i++)
+	{
+		const FixtureSection& section = sections[i];
+		const std::size_t header      = sectionTable + i * 40;
+
+		std::memcpy(image.data() + header, section.name.data(), std::min<std::size_t>(section.name.size(), 8));
+		put<uint32_t>(image, header + 8, section.virtualSize);
+		put<uint32_t>(image, header + 12, rvas[i]);
+		put<uint32_t>(image, header + 16, alignUp(static_cast<uint32_t>(section.data.size()), FILE_ALIGNMENT));
+		put<uint32_t>(image, header + 20, rawOffsets[i]);
+		put<uint32_t>(image, header + 36, section.characteristics);
+
+		const std::size_t offset = layout == PeLayout::Mapped ? rvas[i] : rawOffsets[i];
+		std::copy(section.data.begin(), section.data.end(), image.begin() + static_cast<std::ptrdiff_t>(offset));
+	}
+
+	return image;
+}
+
+static void testHeaders(const bool& is64Bit, const PeLayout& layout)
+{
+	const std::vector<uint8_t> data = buildPe(is64Bit, layout, makeSections());
+	const PeImage image(data.data(), data.size(), layout);
+
+	CHECK(image.Is64Bit() == is64Bit);
+	CHECK(image.GetMachine() == (is64Bit ? 0x8664 : 0x014C));
+	CHECK(image.GetImageBase() == (is64Bit ? 0x140000000ull : 0x00400000ull));
+	CHECK(image.GetTimeDateStamp() == TIME_STAMP);
+	CHECK(image.GetCheckSum() == CHECK_SUM);
+	CHECK(image.GetSizeOfImage() == 0x6000);
+
+	const std::vector<PeSection>& sections = image.GetSections();
+	CHECK(sections.size() == 4);
+
+	// Names of all 8 characters have no terminator
+	CHECK(sections[0].name == ".text" && sections[3].name == ".textbss");
+	CHECK(sections[0].virtualAddress == 0x1000 && sections[1].virtualAddress == 0x2000);
+	CHECK(sections[2].virtualAddress == 0x3000 && sections[3].virtualAddress == 0x5000);
+
+	CHECK(sections[0].IsExecutable() && !sections[0].IsWritable());
+	CHECK(!sections[1].IsExecutable() && !sections[1].IsWritable());
+	CHECK(!sections[2].IsExecutable() && sections[2].IsWritable());
+	CHECK(!sections[3].IsExecutable() && sections[3].IsWritable());
+
+	CHECK(image.FindSection(".rdata") == &sections[1]);
+	CHECK(image.FindSection(".reloc") == nullptr);
+	CHECK(image.FindSectionByRva(0x2000) == &sections[1]);
+	CHECK(image.FindSectionByRva(0x2FFF) == nullptr);
+	CHECK(image.FindSectionByRva(0x3FFF) == &sections[2]);
+	CHECK(image.FindSectionByRva(0x0FFF) == nullptr);
+
+	// The same bytes are found at an RVA in both layouts
+	const uint8_t* pText = image.GetRvaData(0x2000, 14);
+	CHECK(pText != nullptr && std::memcmp(pText, "Constant text", 14) == 0);
+	CHECK(image.GetRvaData(0x1000, 1) != nullptr && *image.GetRvaData(0x1000, 1) == 0xCC);
+	CHECK(image.GetRvaData(0x9000, 1) == nullptr);
+
+	// Data is available up to the end of the section in the layout, but not across it
+	const std::size_t rdataSize = image.GetSectionSize(sections[1]);
+	CHECK(rdataSize == (layout == PeLayout::Mapped ? 0x80 : 0x200));
+	CHECK(image.GetRvaData(static_cast<uint32_t>(0x2000 + rdataSize - 1), 1) != nullptr);
+	CHECK(image.GetRvaData(static_cast<uint32_t>(0x2000 + rdataSize), 1) == nullptr);
+	CHECK(image.GetRvaData(static_cast<uint32_t>(0x2000 + rdataSize - 0x10), 0x20) == nullptr);
+
+	if (layout == PeLayout::Mapped)
+	{
+		// In memory the sections span their virtual size, including the zeroed rest
+		CHECK(image.GetSectionSize(sections[0]) == 0x2F0);
+		CHECK(image.GetSectionSize(sections[2]) == 0x1800);
+		CHECK(image.GetRvaData(0x3100, 4) != nullptr);
+		CHECK(image.GetSectionSize(sections[3]) == 0x100);
+	}
+	else
+	{
+		// On disk only the raw data is there, uninitialized data has none
+		CHECK(image.GetSectionSize(sections[0]) == 0x400);
+		CHECK(image.GetSectionSize(sections[2]) == 0x200);
+		CHECK(image.GetRvaData(0x3100, 4) != nullptr);
+		CHECK(image.GetRvaData(0x3200, 4) == nullptr);
+		CHECK(image.GetSectionSize(sections[3]) == 0);
+	}
+}
+
+static bool throwsOnParse(const std::vector<uint8_t>& data)
+{
+	try
+	{
+		PeImage image(data.data(), data.size(), PeLayout::File);
+		return false;
+	}
+	catch (const std::runtime_error&)
+	{
+		return true;
+	}
+}
+
+static void testInvalidImages()
+{
+	const std::vector<uint8_t> valid = buildPe(true, PeLayout::File, makeSections());
+	CHECK(!throwsOnParse(valid));
+
+	std::vector<uint8_t> data = valid;
+	data[0]                   = 'X';
+	CHECK(throwsOnParse(data));
+
+	data = valid;
+	data[0x80] = 'X';
+	CHECK(throwsOnParse(data));
+
+	data = valid;
+	put<uint16_t>(data, 0x80 + 24, 0x107);
+	CHECK(throwsOnParse(data));
+
+	// The NT headers must lie inside the data
+	data = valid;
+	put<uint32_t>(data, 0x3C, 0x7FFFFFF0);
+	CHECK(throwsOnParse(data));
+
+	// A section table cut off by the end of the data
+	CHECK(throwsOnParse(std::vector<uint8_t>(valid.begin(), valid.begin() + 0x1A0)));
+	CHECK(throwsOnParse({}));
+
+	// Truncated section data is clamped instead
+	const std::vector<uint8_t> truncated(valid.begin(), valid.begin() + 0x500);
+	const PeImage image(truncated.data(), truncated.size(), PeLayout::File);
+	CHECK(image.GetSectionSize(image.GetSections()[0]) == 0x100);
+	CHECK(image.GetSectionSize(image.GetSections()[1]) == 0);
+}
+
+// Signatures are only searched in executable sections unless they name one, and their steps are followed
+static void testImageScanner(const bool& is64Bit, const PeLayout& layout)
+{
+	std::vector<FixtureSection> sections = makeSections();
+	std::vector<uint8_t>& code           = sections[0].data;
+
+	// A function at 0x1100 called from 0x1040, relative to the end of the call
+	const uint8_t prologue[] = { 0x40, 0x53, 0x48, 0x83, 0xEC, 0x20, 0x48, 0x8B, 0xD9 };
+	std::memcpy(code.data() + 0x100, prologue, sizeof(prologue));
+
+	const uint8_t call[] = { 0x33, 0xC9, 0xE8, 0xBB, 0x00, 0x00, 0x00, 0x85, 0xC0 };
+	std::memcpy(code.data() + 0x3E, call, sizeof(call));
+
+	// A call far outside of the image
+	const uint8_t badCall[] = { 0x31, 0xD2, 0xE8, 0x00, 0x00, 0x00, 0x70, 0x90 };
+	std::memcpy(code.data() + 0x200, badCall, sizeof(badCall));
+
+	// The same bytes in a data section are no code
+	std::memcpy(sections[1].data.data() + 0x40, prologue, sizeof(prologue));
+
+	const std::vector<uint8_t> data = buildPe(is64Bit, layout, sections);
+	const PeImage image(data.data(), data.size(), layout);
+
+	ImageScanner scanner(image);
+	const std::size_t direct   = scanner.Add(SignaturePattern::Parse("40 53 48 83 EC 20 48 8B D9"));
+	const std::size_t followed = scanner.Add(SignaturePattern::Parse("33 C9 E8 ?? ?? ?? ?? 85 C0").FollowRelative(3));
+	const std::size_t skipped  = scanner.Add(SignaturePattern::Parse("48 83 EC 20").Skip(-2));
+	const std::size_t outside  = scanner.Add(SignaturePattern::Parse("31 D2 E8 ?? ?? ?? ??").FollowRelative(3));
+	const std::size_t named    = scanner.Add(SignaturePattern::Parse("43 6F 6E 73 74 61 6E 74"), ".rdata");
+	const std::size_t missing  = scanner.Add(SignaturePattern::Parse("43 6F 6E 73 74 61 6E 74"));
+
+	const std::vector<uint32_t> rvas = scanner.Scan();
+	CHECK(rvas[direct] == 0x1100);
+	CHECK(rvas[followed] == 0x1100);
+	CHECK(rvas[skipped] == 0x1100);
+	CHECK(rvas[outside] == ImageScanner::NOT_FOUND);
+	CHECK(rvas[named] == 0x2000);
+	CHECK(rvas[missing] == ImageScanner::NOT_FOUND);
+
+	const std::vector<std::size_t> counts = scanner.CountMatches();
+	CHECK(counts[direct] == 1);
+	CHECK(counts[named] == 1);
+	CHECK(counts[missing] == 0);
+}
+
+// Addresses are relative to the scanned image and written to the cache of the executable on disk
+static void testFindFunctions()
+{
+	std::vector<FixtureSection> sections = makeSections();
+
+	const uint8_t prologue[] = { 0x40, 0x53, 0x48, 0x83, 0xEC, 0x20, 0x48, 0x8B, 0xD9 };
+	std::memcpy(sections[0].data.data() + 0x100, prologue, sizeof(prologue));
+
+	const std::filesystem::path directory      = std::filesystem::temp_directory_path() / "PeImageTests";
+	const std::filesystem::path executablePath = directory / "Game.exe";
+	const std::filesystem::path cachePath      = directory / "Redirect.cache";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	const std::vector<uint8_t> file = buildPe(true, PeLayout::File, sections);
+	std::ofstream(executablePath, std::ios::binary).write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+
+	const std::vector<uint8_t> mapped = buildPe(true, PeLayout::Mapped, sections);
+	const PeImage image(mapped.data(), mapped.size(), PeLayout::Mapped);
+	const uintptr_t base = reinterpret_cast<uintptr_t>(mapped.data());
+
+	for (int i = 0; i < 2; i++)
+	{
+		ImageScanner scanner(image);
+		scanner.Add(SignaturePattern::Parse("40 53 48 83 EC 20 48 8B D9"));
+		scanner.Add(SignaturePattern::Parse("43 6F 6E 73 74 61 6E 74"));
+
+		const std::vector<uintptr_t> addresses = findFunctions(scanner, executablePath, cachePath);
+		CHECK(addresses.size() == 2);
+		CHECK(addresses[0] == base + 0x1100);
+		CHECK(addresses[1] == static_cast<uintptr_t>(-1));
+		CHECK(std::filesystem::exists(cachePath));
+	}
+
+	ImageFingerprint fingerprint;
+	AddressCache cache;
+	CHECK(AddressCache::ReadFingerprint(executablePath, fingerprint));
+	CHECK(cache.Load(cachePath, fingerprint));
+
+	// Without a readable executable nothing is cached, but the functions are still found
+	std::filesystem::remove(cachePath);
+	ImageScanner scanner(image);
+	scanner.Add(SignaturePattern::Parse("40 53 48 83 EC 20 48 8B D9"));
+	CHECK(findFunctions(scanner, directory / "Missing.exe", cachePath)[0] == base + 0x1100);
+	CHECK(!std::filesystem::exists(cachePath));
+
+	std::filesystem::remove_all(directory);
+}
+
+int main()
+{
+	for (const bool is64Bit : { false, true })
+	{
+		for (const PeLayout layout : { PeLayout::File, PeLayout::Mapped })
+		{
+			testHeaders(is64Bit, layout);
+			testImageScanner(is64Bit, layout);
+		}
+	}
+
+	testInvalidImages();
+	testFindFunctions();
+
+	return finishTests("PeImageTests");
+}
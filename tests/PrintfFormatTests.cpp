@@ -0,0 +1,154 @@
+/*
+ *  File: PrintfFormatTests.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../Common/PrintfFormat.hpp"
+#include "../Common/TranslationCompiler.hpp"
+#include "TestUtils.hpp"
+
+static std::string arguments(const std::string& format)
+{
+	std::string result;
+	return getPrintfArguments(format, result) ? result : "invalid";
+}
+
+static void testArguments()
+{
+	CHECK(arguments("") == "");
+	CHECK(arguments("No conversions") == "");
+	CHECK(arguments("100%%") == "");
+	CHECK(arguments("%d/%d HP") == "ii");
+	CHECK(arguments("%-5.2f%%") == "d");
+	CHECK(arguments("%s: %lld %zu %Lf %ls %p") == "sqzDSp");
+	CHECK(arguments("%I64d %I32d %Id %hhx %lu") == "qizil");
+	CHECK(arguments("%*.*s") == "iis");
+	CHECK(arguments("%c%C") == "ii");
+
+	// Positional arguments are returned in argument order
+	CHECK(arguments("%2$s has %1$d HP") == "is");
+	CHECK(arguments("%1$d %3$s %2$f") == "ids");
+
+	// Invalid formats
+	CHECK(arguments("100%") == "invalid");
+	CHECK(arguments("%n") == "invalid");
+	CHECK(arguments("%y") == "invalid");
+	CHECK(arguments("%lq") == "invalid");
+	CHECK(arguments("%1$d %d") == "invalid");
+	CHECK(arguments("%d %1$d") == "invalid");
+	CHECK(arguments("%1$d %1$d") == "invalid");
+	CHECK(arguments("%1$d %3$d") == "invalid");
+	CHECK(arguments("%0$d") == "invalid");
+	CHECK(arguments("%100$d") == "invalid");
+	CHECK(arguments("%1$*d") == "invalid");
+}
+
+static void testTranslatedFormats()
+{
+	// Same arguments, possibly reordered
+	CHECK(isTranslatedFormatValid("%sは%dのダメージを受けた", "%s took %d damage"));
+	CHECK(isTranslatedFormatValid("%sは%dのダメージを受けた", "%2$d damage to %1$s"));
+	CHECK(isTranslatedFormatValid("%d%%", "%d %%"));
+	CHECK(isTranslatedFormatValid("%x", "%d"));
+
+	// Different, missing or additional arguments
+	CHECK(!isTranslatedFormatValid("%sは%dのダメージを受けた", "%d damage to %s"));
+	CHECK(!isTranslatedFormatValid("%sは%dのダメージを受けた", "%1$s took %1$s damage"));
+	CHECK(!isTranslatedFormatValid("%d", "%d %d"));
+	CHECK(!isTranslatedFormatValid("%d", "Damage"));
+	CHECK(!isTranslatedFormatValid("%d", "%s"));
+	CHECK(!isTranslatedFormatValid("%d", "%lld"));
+
+	// A literal '%' in the translation of a format has to be escaped
+	CHECK(!isTranslatedFormatValid("%d%%", "%d%"));
+	CHECK(!isTranslatedFormatValid("%d%%", "%d% off"));
+
+	// Originals that are no format do not restrict their translation
+	CHECK(isTranslatedFormatValid("攻撃", "Attack 100%"));
+	CHECK(isTranslatedFormatValid("10%アップ", "10% up"));
+}
+
+//
+// Every entry is compiled, entries with mismatching conversions are reported and flagged
+// as text only, e.g. copied strings like "10% damage" whose '%' happens to parse
+//
+static void testCompiledCatalogue()
+{
+	std::istringstream input(R"({
+		"%d HP": { "text": "%d LP", "pixel_lengths": [ 10 ] },
+		"%s %d": { "text": "%2$d %1$s", "pixel_lengths": [ 10 ] },
+		"%d%%": { "text": "%d%", "pixel_lengths": [ 10 ] },
+		"%s": { "text": "%d", "pixel_lengths": [ 10 ] },
+		"Plain": { "text": "100%", "pixel_lengths": [ 10 ] },
+		"10% damage": { "text": "10% Schaden", "pixel_lengths": [ 10 ] },
+		"50% increase": { "text": "50% mehr", "pixel_lengths": [ 10 ] }
+	})");
+
+	TranslationEncoders encoders;
+	encoders.toSjis = [](const std::string& utf8) { return utf8; };
+
+	TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+	const std::vector<std::string> textOnlyKeys = compileEternalTranslations(input, builder, encoders);
+
+	CHECK(builder.Size() == 7);
+	CHECK((textOnlyKeys == std::vector<std::string>{ "%d%%", "%s", "10% damage", "50% increase" }));
+
+	TranslationBundle bundle;
+	CHECK(bundle.Load(builder.Build()));
+
+	for (const char* pKey : { "%d HP", "%s %d", "Plain" })
+	{
+		const TranslationRecord record = bundle.Find(pKey);
+		CHECK(record && record.IsUsableAsFormat());
+	}
+
+	for (const char* pKey : { "%d%%", "%s", "10% damage", "50% increase" })
+	{
+		const TranslationRecord record = bundle.Find(pKey);
+		CHECK(record && !record.IsUsableAsFormat());
+	}
+
+	CHECK(std::string(bundle.Find("10% damage").GetText()) == "10% Schaden");
+
+	// A later file replaces the flag together with the text
+	TranslationBundleBuilder merged(BundleKeyEncoding::CP932);
+	merged.Add("%s", "%d", u"", {}, false);
+	merged.Add("%s", "%s!", u"", {}, true);
+	TranslationBundle mergedBundle;
+	CHECK(mergedBundle.Load(merged.Build()));
+	CHECK(mergedBundle.Find("%s").IsUsableAsFormat());
+}
+
+int main()
+{
+	testArguments();
+	testTranslatedFormats();
+	testCompiledCatalogue();
+
+	return finishTests("PrintfFormatTests");
+}
@@ -0,0 +1,246 @@
+/*
+ *  File: SignatureScannerTests.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../Common/SignatureScanner.hpp"
+#include "TestUtils.hpp"
+
+static std::vector<uint8_t> makeRandomData(const std::size_t& size, const uint32_t& seed)
+{
+	std::mt19937 rng(seed);
+	std::vector<uint8_t> data(size);
+
+	for (uint8_t& byte : data)
+		byte = static_cast<uint8_t>(rng());
+
+	return data;
+}
+
+static void plant(std::vector<uint8_t>& data, const std::size_t& offset, const SignaturePattern& pattern)
+{
+	for (std::size_t i = 0; i < pattern.Size(); i++)
+	{
+		if (pattern.IsFixed(i))
+			data[offset + i] = pattern.GetBytes()[i];
+	}
+}
+
+// The first match by checking every position, what the scanner has to agree with
+static std::size_t findNaive(const std::vector<uint8_t>& data, const SignaturePattern& pattern)
+{
+	for (std::size_t pos = 0; pos + pattern.Size() <= data.size(); pos++)
+	{
+		if (pattern.Matches(data.data() + pos))
+			return pos;
+	}
+
+	return SignatureScanner::NOT_FOUND;
+}
+
+static std::vector<SignaturePattern> makePatterns()
+{
+	return {
+		SignaturePattern::Parse("40 53 55 56 41 56 41 57 48 81"),
+		SignaturePattern::Parse("48 89 5C 24 10 57 48 83 EC 20 48 8B F9 48 C7 C3"),
+		SignaturePattern::Parse("48 8B 05 ?? ?? ?? ?? 48 85 C0 74 ??"),
+		SignaturePattern::Parse("E8 ?? ?? ?? ?? 4? 8B ?8"),
+		SignaturePattern::Parse("48 89 4C 24 08 48 89 54 24 10 4C 89 44 24 18 4C 89 4C 24 20 53 56"),
+		SignaturePattern::Parse("DE AD BE EF 13 37 C0 DE"),
+	};
+}
+
+// All patterns are found in one pass at their first match
+static void testSinglePass()
+{
+	std::vector<uint8_t> data                  = makeRandomData(1024 * 1024, 1);
+	const std::vector<SignaturePattern> patterns = makePatterns();
+
+	plant(data, 1000, patterns[0]);
+	plant(data, 2000, patterns[1]);
+	plant(data, 3000, patterns[1]);
+	plant(data, 500001, patterns[2]);
+	plant(data, 700000, patterns[3]);
+	plant(data, data.size() - patterns[4].Size(), patterns[4]);
+
+	SignatureScanner scanner;
+	for (std::size_t i = 0; i < patterns.size(); i++)
+		CHECK(scanner.Add(patterns[i]) == i);
+
+	CHECK(scanner.Size() == patterns.size());
+
+	const std::vector<std::size_t> offsets = scanner.Scan(data.data(), data.size());
+	CHECK(offsets.size() == patterns.size());
+
+	for (std::size_t i = 0; i < patterns.size(); i++)
+		CHECK(offsets[i] == findNaive(data, patterns[i]));
+
+	CHECK(offsets[0] == 1000);
+	CHECK(offsets[1] == 2000);
+	CHECK(offsets[4] == data.size() - patterns[4].Size());
+	CHECK(offsets[5] == SignatureScanner::NOT_FOUND);
+}
+
+static void testEdgeCases()
+{
+	SignatureScanner scanner;
+	const std::size_t wildcards = scanner.Add(SignaturePattern::Parse("?? ?? ??"));
+	const std::size_t single    = scanner.Add(SignaturePattern::Parse("C3"));
+	const std::size_t longer    = scanner.Add(SignaturePattern::Parse("C3 C3 C3 C3"));
+
+	// Patterns without a fixed byte are never found
+	const uint8_t bytes[] = { 0x90, 0x90, 0xC3, 0xC3, 0xC3 };
+	std::vector<std::size_t> offsets = scanner.Scan(bytes, sizeof(bytes));
+	CHECK(offsets[wildcards] == SignatureScanner::NOT_FOUND);
+	CHECK(offsets[single] == 2);
+	CHECK(offsets[longer] == SignatureScanner::NOT_FOUND);
+
+	offsets = scanner.Scan(bytes, 0);
+	CHECK(offsets[single] == SignatureScanner::NOT_FOUND);
+
+	// A match in the last byte
+	offsets = scanner.Scan(bytes, 3);
+	CHECK(offsets[single] == 2);
+}
+
+// Chunks scanned on several threads give the same offsets, also for matches across chunk borders
+static void testParallel()
+{
+	static constexpr std::size_t CHUNK_SIZE = 4 * 1024 * 1024;
+
+	std::vector<uint8_t> data                  = makeRandomData(5 * CHUNK_SIZE + 123, 2);
+	const std::vector<SignaturePattern> patterns = makePatterns();
+
+	plant(data, CHUNK_SIZE - 3, patterns[0]);
+	plant(data, 3 * CHUNK_SIZE + 17, patterns[1]);
+	plant(data, 2 * CHUNK_SIZE - 1, patterns[2]);
+	plant(data, 4 * CHUNK_SIZE + 5, patterns[1]);
+	plant(data, data.size() - patterns[4].Size(), patterns[4]);
+
+	SignatureScanner scanner;
+	for (const SignaturePattern& pattern : patterns)
+		scanner.Add(pattern);
+
+	const std::vector<std::size_t> expected = scanner.Scan(data.data(), data.size());
+
+	for (std::size_t i = 0; i < patterns.size(); i++)
+		CHECK(expected[i] == findNaive(data, patterns[i]));
+
+	CHECK(scanner.ScanParallel(data.data(), data.size(), 4) == expected);
+	CHECK(scanner.ScanParallel(data.data(), data.size(), 1) == expected);
+	CHECK(scanner.ScanParallel(data.data(), data.size()) == expected);
+}
+
+static std::vector<ScanKernel> getSupportedKernels()
+{
+	std::vector<ScanKernel> kernels = { ScanKernel::Scalar };
+
+#if CPU_FEATURES_X86
+	if (CpuFeatures::Get().sse2)
+		kernels.push_back(ScanKernel::SSE2);
+
+	if (CpuFeatures::Get().avx2)
+		kernels.push_back(ScanKernel::AVX2);
+#endif
+
+	return kernels;
+}
+
+//
+// Every kernel finds the same offsets as the naive search, for patterns cut from random
+// positions of the data with random wildcards and for sizes that end inside a vector block
+//
+static void testKernels()
+{
+	std::mt19937 rng(3);
+
+	for (int round = 0; round < 200; round++)
+	{
+		// Few distinct byte values, so the anchors see many candidates that do not match
+		const std::size_t size = round < 100 ? static_cast<std::size_t>(round) : 1000 + rng() % 5000;
+		std::vector<uint8_t> data(size);
+		for (uint8_t& byte : data)
+			byte = static_cast<uint8_t>(rng() % 6);
+
+		std::vector<SignaturePattern> patterns;
+		for (int i = 0; i < 8; i++)
+		{
+			const std::size_t length = 1 + rng() % 40;
+			std::string text;
+
+			for (std::size_t j = 0; j < length; j++)
+			{
+				const uint32_t kind = rng() % 8;
+				char byte[4];
+
+				if (kind == 0)
+					std::snprintf(byte, sizeof(byte), "??");
+				else if (kind == 1)
+					std::snprintf(byte, sizeof(byte), "0?");
+				else if (size >= length)
+					std::snprintf(byte, sizeof(byte), "%02X", data[(i * 977 + round * 31) % (size - length + 1) + j]);
+				else
+					std::snprintf(byte, sizeof(byte), "%02X", static_cast<unsigned>(rng() % 6));
+
+				text += byte;
+				text += ' ';
+			}
+
+			patterns.push_back(SignaturePattern::Parse(text));
+		}
+
+		SignatureScanner scanner;
+		for (const SignaturePattern& pattern : patterns)
+			scanner.Add(pattern);
+
+		std::vector<std::size_t> expected(patterns.size());
+		for (std::size_t i = 0; i < patterns.size(); i++)
+		{
+			// Patterns without fixed bytes are never reported
+			bool hasFixed = false;
+			for (std::size_t j = 0; j < patterns[i].Size(); j++)
+				hasFixed = hasFixed || patterns[i].IsFixed(j);
+
+			expected[i] = hasFixed ? findNaive(data, patterns[i]) : SignatureScanner::NOT_FOUND;
+		}
+
+		for (const ScanKernel& kernel : getSupportedKernels())
+			CHECK(scanner.Scan(data.data(), data.size(), kernel) == expected);
+	}
+}
+
+int main()
+{
+	testSinglePass();
+	testEdgeCases();
+	testParallel();
+	testKernels();
+
+	return finishTests("SignatureScannerTests");
+}
@@ -0,0 +1,247 @@
+/*
+ *  File: SnapshotReloaderTests.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Common/SnapshotReloader.hpp"
+#include "TestUtils.hpp"
+
+static std::atomic<int> g_liveSnapshots = 0;
+
+struct TestSnapshot
+{
+	static constexpr uint32_t ALIVE = 0xA11CE;
+	static constexpr uint32_t DEAD  = 0xDEAD;
+
+	explicit TestSnapshot(const int& v) :
+		value(v)
+	{
+		g_liveSnapshots++;
+	}
+
+	~TestSnapshot()
+	{
+		canary = DEAD;
+		g_liveSnapshots--;
+	}
+
+	int value;
+	volatile uint32_t canary = ALIVE;
+};
+
+using Reloader = SnapshotReloader<TestSnapshot>;
+
+static void testReadGuards()
+{
+	Reloader reloader;
+	CHECK(!reloader.Read());
+
+	reloader.Publish(std::make_unique<TestSnapshot>(1));
+
+	{
+		const Reloader::ReadGuard first = reloader.Read();
+		CHECK(first && first->value == 1);
+
+		reloader.Publish(std::make_unique<TestSnapshot>(2));
+		CHECK(reloader.Read()->value == 2);
+
+		// The replaced snapshot is held by the guard, no amount of polls may free it
+		for (int i = 0; i < 10; i++)
+			reloader.Reclaim();
+
+		CHECK(reloader.GetRetiredCount() == 1);
+		CHECK(first->value == 1 && first->canary == TestSnapshot::ALIVE);
+
+		// Releasing with an active reader frees nothing
+		reloader.Release();
+		CHECK(g_liveSnapshots == 2);
+	}
+
+	reloader.Reclaim();
+	reloader.Reclaim();
+	CHECK(reloader.GetRetiredCount() == 0);
+	CHECK(g_liveSnapshots == 1);
+
+	// Without readers a replaced snapshot is freed after two phases
+	reloader.Publish(std::make_unique<TestSnapshot>(3));
+	const uint64_t phase = reloader.GetPhase();
+	reloader.Reclaim();
+	reloader.Reclaim();
+	CHECK(reloader.GetPhase() == phase + 2);
+	CHECK(g_liveSnapshots == 1);
+
+	reloader.Publish(nullptr);
+	CHECK(reloader.Read()->value == 3);
+
+	reloader.Release();
+	CHECK(!reloader.Read());
+	CHECK(g_liveSnapshots == 0);
+}
+
+static void testConcurrentReaders()
+{
+	Reloader reloader;
+	reloader.Publish(std::make_unique<TestSnapshot>(0));
+
+	std::atomic<bool> stop = false;
+	std::atomic<int> deadReads = 0;
+	std::vector<std::thread> readers;
+
+	for (int i = 0; i < 4; i++)
+	{
+		readers.emplace_back([&reloader, &stop, &deadReads]() {
+			while (!stop.load(std::memory_order_relaxed))
+			{
+				const Reloader::ReadGuard guard = reloader.Read();
+				if (guard->canary != TestSnapshot::ALIVE)
+					deadReads++;
+
+				std::this_thread::yield();
+
+				if (guard->canary != TestSnapshot::ALIVE)
+					deadReads++;
+			}
+		});
+	}
+
+	for (int i = 1; i <= 2000; i++)
+	{
+		reloader.Publish(std::make_unique<TestSnapshot>(i));
+		reloader.Reclaim();
+	}
+
+	stop = true;
+	for (std::thread& reader : readers)
+		reader.join();
+
+	CHECK(deadReads == 0);
+	CHECK(reloader.Read()->value == 2000);
+
+	reloader.Reclaim();
+	reloader.Reclaim();
+	CHECK(reloader.GetRetiredCount() == 0);
+	CHECK(g_liveSnapshots == 1);
+}
+
+static void writeValue(const std::filesystem::path& path, const int& value)
+{
+	std::ofstream(path, std::ios::trunc) << value;
+}
+
+static int readValue(const std::filesystem::path& path)
+{
+	std::ifstream file(path);
+	int value = 0;
+
+	if (!(file >> value))
+		throw std::runtime_error("Invalid file");
+
+	return value;
+}
+
+// Wait for the watcher to publish the expected value, the files are polled in the background
+static bool waitForValue(const Reloader& reloader, const int& value)
+{
+	const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+
+	while (std::chrono::steady_clock::now() < deadline)
+	{
+		{
+			const Reloader::ReadGuard guard = reloader.Read();
+			if (guard && guard->value == value)
+				return true;
+		}
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	return false;
+}
+
+static void touch(const std::filesystem::path& path, const int& seconds)
+{
+	std::filesystem::last_write_time(path, std::filesystem::last_write_time(path) + std::chrono::seconds(seconds));
+}
+
+static void testReloadFromFiles()
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "SnapshotReloaderTests";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	const std::filesystem::path file = directory / "value.txt";
+	writeValue(file, 1);
+
+	const auto loader = [&file]() { return std::make_unique<TestSnapshot>(readValue(file)); };
+
+	{
+		Reloader reloader;
+		reloader.Start({ file }, loader, loader, std::chrono::milliseconds(10));
+		CHECK(waitForValue(reloader, 1));
+
+		// Changed files are picked up once they settled for a poll
+		writeValue(file, 2);
+		touch(file, 1);
+		CHECK(waitForValue(reloader, 2));
+
+		// A failing load keeps the current snapshot
+		std::ofstream(file, std::ios::trunc) << "broken";
+		touch(file, 2);
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+		CHECK(reloader.Read()->value == 2);
+
+		writeValue(file, 3);
+		touch(file, 3);
+		CHECK(waitForValue(reloader, 3));
+
+		// The last reload may not have been freed yet if a check held a guard at the time
+		reloader.Stop();
+		reloader.Reclaim();
+		reloader.Reclaim();
+		CHECK(reloader.GetRetiredCount() == 0);
+		CHECK(g_liveSnapshots == 1);
+	}
+
+	CHECK(g_liveSnapshots == 0);
+
+	std::filesystem::remove_all(directory);
+}
+
+int main()
+{
+	testReadGuards();
+	testConcurrentReaders();
+	testReloadFromFiles();
+
+	return finishTests("SnapshotReloaderTests");
+}
@@ -0,0 +1,62 @@
+/*
+ *  File: TestUtils.hpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#pragma once
+
+#include <cstdio>
+
+//
+// Minimal checks for the test programs. A failed check is reported with its
+// location and the program continues, so one run shows all failures.
+//
+inline int& getTestFailures()
+{
+	static int failures = 0;
+	return failures;
+}
+
+#define CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			std::fprintf(stderr, "%s:%d: Check failed: %s\n", __FILE__, __LINE__, #condition); \
+			getTestFailures()++; \
+		} \
+	} while (0)
+
+// Result of main, prints a summary of the checks
+inline int finishTests(const char* pName)
+{
+	if (getTestFailures() == 0)
+	{
+		std::printf("%s: All checks passed\n", pName);
+		return 0;
+	}
+
+	std::printf("%s: %d checks failed\n", pName, getTestFailures());
+	return 1;
+}
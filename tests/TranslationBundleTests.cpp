@@ -0,0 +1,207 @@
+/*
+ *  File: TranslationBundleTests.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "../Common/Cp932Transcoder.hpp"
+#include "../Common/TranslationBundle.hpp"
+#include "../Common/TranslationCompiler.hpp"
+#include "TestUtils.hpp"
+
+//
+// Lookups by the raw CP932 bytes the EternalRedirect hooks receive
+//
+static void testRawKeyLookups()
+{
+	const std::string key    = Cp932Transcoder::FromUtf8("攻撃力が上がった！");
+	const std::string text   = Cp932Transcoder::FromUtf8("Attack rose!\nNice");
+	const std::string ascii  = "Continue";
+	const std::string prefix = key.substr(0, key.size() - 2);
+
+	TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+	builder.Add(key, text, u"", { 120, 40 });
+	builder.Add(ascii, "Weiter", u"");
+
+	TranslationBundle bundle;
+	CHECK(bundle.Load(builder.Build()));
+	CHECK(bundle.Size() == 2);
+
+	// The null terminated and the sized lookup find the same record
+	const TranslationRecord record = bundle.Find(key.c_str());
+	CHECK(record);
+	CHECK(bundle.Find(key.data(), key.size()));
+	CHECK(record.GetText() == text);
+	CHECK(record.GetTextLength() == text.size());
+
+	CHECK(record.GetLineCount() == 2);
+	CHECK(std::string(record.GetLine(0)) == "Attack rose!");
+	CHECK(std::string(record.GetLine(1)) == "Nice");
+	CHECK(record.GetPixelLengthCount() == 2);
+	CHECK(record.GetPixelLength(0) == 120);
+	CHECK(record.GetPixelLength(1) == 40);
+	CHECK(record.GetPixelLength(2) == 0);
+
+	CHECK(std::string(bundle.Find(ascii.c_str()).GetText()) == "Weiter");
+
+	// Misses, including keys sharing a prefix with a stored key
+	CHECK(!bundle.Find(""));
+	CHECK(!bundle.Find("1234"));
+	CHECK(!bundle.Find("HP 100/100"));
+	CHECK(!bundle.Find(prefix.c_str()));
+	CHECK(!bundle.Find((key + "x").c_str()));
+	CHECK(!bundle.Find(key.data(), key.size() - 1));
+	CHECK(!bundle.Find(static_cast<const char*>(nullptr)));
+}
+
+// Adding a key again replaces its translation
+static void testReplacedKeys()
+{
+	TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+	builder.Add("key", "first", u"");
+	builder.Add("key", "second", u"");
+
+	TranslationBundle bundle;
+	CHECK(bundle.Load(builder.Build()));
+	CHECK(bundle.Size() == 1);
+	CHECK(std::string(bundle.Find("key").GetText()) == "second");
+}
+
+// Every key of a larger catalogue is found, and none of a disjoint set
+static void testManyKeys()
+{
+	static constexpr std::size_t COUNT = 20000;
+
+	TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+	for (std::size_t i = 0; i < COUNT; i++)
+		builder.Add("key" + std::to_string(i), "text" + std::to_string(i), u"");
+
+	TranslationBundle bundle;
+	CHECK(bundle.Load(builder.Build()));
+	CHECK(bundle.Size() == COUNT);
+
+	std::size_t found  = 0;
+	std::size_t missed = 0;
+	for (std::size_t i = 0; i < COUNT; i++)
+	{
+		const TranslationRecord record = bundle.Find(("key" + std::to_string(i)).c_str());
+		if (record && record.GetText() == "text" + std::to_string(i))
+			found++;
+
+		if (!bundle.Find(("other" + std::to_string(i)).c_str()))
+			missed++;
+	}
+
+	CHECK(found == COUNT);
+	CHECK(missed == COUNT);
+}
+
+// Bundles of another version or with broken sizes are rejected instead of being read
+static void testInvalidBundles()
+{
+	TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+	builder.Add("key", "text", u"");
+	const std::vector<char> data = builder.Build();
+
+	TranslationBundle bundle;
+
+	std::vector<char> truncated(data.begin(), data.end() - 1);
+	CHECK(!bundle.Load(std::move(truncated)));
+	CHECK(!bundle.IsLoaded());
+	CHECK(!bundle.Find("key"));
+
+	std::vector<char> wrongVersion = data;
+	wrongVersion[4]++;
+	CHECK(!bundle.Load(std::move(wrongVersion)));
+
+	CHECK(!bundle.Load(std::vector<char>()));
+}
+
+// Mapped bundles stay usable when the file is replaced, and are skipped for newer JSON files
+static void testBundleFiles()
+{
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "TranslationBundleTests";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	const std::filesystem::path bundlePath = directory / "tr.bin";
+	const std::filesystem::path jsonPath   = directory / "tr.json";
+
+	TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+	builder.Add("key", "text", u"");
+	const std::vector<char> data = builder.Build();
+	std::ofstream(bundlePath, std::ios::binary).write(data.data(), static_cast<std::streamsize>(data.size()));
+
+	TranslationBundle bundle;
+	CHECK(!bundle.Open(directory / "missing.bin"));
+	CHECK(bundle.Open(bundlePath));
+
+	// Replaced like the packer does it, the mapped bundle keeps the old content and a new one sees the new file
+	TranslationBundleBuilder newBuilder(BundleKeyEncoding::CP932);
+	newBuilder.Add("key", "new text", u"");
+	const std::vector<char> newData = newBuilder.Build();
+	std::ofstream(directory / "tr.bin.tmp", std::ios::binary).write(newData.data(), static_cast<std::streamsize>(newData.size()));
+	std::filesystem::rename(directory / "tr.bin.tmp", bundlePath);
+
+	CHECK(std::string(bundle.Find("key").GetText()) == "text");
+
+	TranslationBundle newBundle;
+	CHECK(newBundle.Open(bundlePath));
+	CHECK(std::string(newBundle.Find("key").GetText()) == "new text");
+
+	std::ofstream(directory / "tr.bin.tmp", std::ios::binary) << "replaced";
+	std::filesystem::rename(directory / "tr.bin.tmp", bundlePath);
+
+	TranslationBundle broken;
+	CHECK(!broken.Open(bundlePath));
+	CHECK(std::string(newBundle.Find("key").GetText()) == "new text");
+
+	CHECK(!isBundleCurrent(directory / "missing.bin", {}));
+	CHECK(isBundleCurrent(bundlePath, { jsonPath }));
+
+	std::ofstream(jsonPath) << "{}";
+	std::filesystem::last_write_time(jsonPath, std::filesystem::last_write_time(bundlePath) - std::chrono::seconds(10));
+	CHECK(isBundleCurrent(bundlePath, { jsonPath }));
+
+	std::filesystem::last_write_time(jsonPath, std::filesystem::last_write_time(bundlePath) + std::chrono::seconds(10));
+	CHECK(!isBundleCurrent(bundlePath, { jsonPath }));
+
+	std::filesystem::remove_all(directory);
+}
+
+int main()
+{
+	testRawKeyLookups();
+	testReplacedKeys();
+	testManyKeys();
+	testInvalidBundles();
+	testBundleFiles();
+
+	return finishTests("TranslationBundleTests");
+}
@@ -0,0 +1,124 @@
+/*
+ *  File: TranslationPointerCacheTests.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "../Common/TranslationBundle.hpp"
+#include "../Common/TranslationPointerCache.hpp"
+#include "TestUtils.hpp"
+
+static void loadBundle(TranslationBundle& bundle)
+{
+	TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+	builder.Add("Attack", "Angriff", u"");
+	builder.Add("Defend", "Verteidigen", u"");
+	builder.Add("Attack!", "Angriff!", u"");
+	CHECK(bundle.Load(builder.Build()));
+}
+
+// Repeated lookups of the same pointer give the same result as the bundle
+static void testCachedLookups()
+{
+	TranslationBundle bundle;
+	loadBundle(bundle);
+
+	// Heap allocated cache, it is too large to be placed on the stack comfortably
+	std::unique_ptr<TranslationPointerCache> pCache = std::make_unique<TranslationPointerCache>();
+
+	static const char ATTACK[] = "Attack";
+	static const char OTHER[]  = "Flee";
+
+	for (int i = 0; i < 3; i++)
+	{
+		const TranslationRecord record = pCache->Find(bundle, ATTACK);
+		CHECK(record);
+		CHECK(record && std::string(record.GetText()) == "Angriff");
+
+		// Misses are cached as well
+		CHECK(!pCache->Find(bundle, OTHER));
+	}
+
+	CHECK(!pCache->Find(bundle, nullptr));
+}
+
+// A string at a cached address whose length or outer bytes changed is looked up again
+static void testChangedStrings()
+{
+	TranslationBundle bundle;
+	loadBundle(bundle);
+
+	std::unique_ptr<TranslationPointerCache> pCache = std::make_unique<TranslationPointerCache>();
+
+	char buffer[16] = "Attack";
+	CHECK(std::string(pCache->Find(bundle, buffer).GetText()) == "Angriff");
+
+	std::strcpy(buffer, "Defend");
+	CHECK(std::string(pCache->Find(bundle, buffer).GetText()) == "Verteidigen");
+
+	std::strcpy(buffer, "Attack!");
+	CHECK(std::string(pCache->Find(bundle, buffer).GetText()) == "Angriff!");
+
+	std::strcpy(buffer, "Attack");
+	CHECK(std::string(pCache->Find(bundle, buffer).GetText()) == "Angriff");
+
+	buffer[0] = '\0';
+	CHECK(!pCache->Find(bundle, buffer));
+
+	std::strcpy(buffer, "Defend");
+	CHECK(pCache->Find(bundle, buffer));
+}
+
+// After a clear the records of another bundle are returned
+static void testClear()
+{
+	TranslationBundle first;
+	loadBundle(first);
+
+	TranslationBundleBuilder builder(BundleKeyEncoding::CP932);
+	builder.Add("Attack", "Attaque", u"");
+
+	TranslationBundle second;
+	CHECK(second.Load(builder.Build()));
+
+	std::unique_ptr<TranslationPointerCache> pCache = std::make_unique<TranslationPointerCache>();
+
+	static const char ATTACK[] = "Attack";
+	CHECK(std::string(pCache->Find(first, ATTACK).GetText()) == "Angriff");
+
+	pCache->Clear();
+	CHECK(std::string(pCache->Find(second, ATTACK).GetText()) == "Attaque");
+}
+
+int main()
+{
+	testCachedLookups();
+	testChangedStrings();
+	testClear();
+
+	return finishTests("TranslationPointerCacheTests");
+}
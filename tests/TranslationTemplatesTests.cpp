@@ -0,0 +1,311 @@
+/*
+ *  File: TranslationTemplatesTests.cpp
+ *  Copyright (c) 2025 Sinflower
+ *
+ *  MIT License
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to deal
+ *  in the Software without restriction, including without limitation the rights
+ *  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ *  copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in all
+ *  copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ *  SOFTWARE.
+ *
+ */
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <version>
+
+#ifdef __cpp_lib_format
+#include <format>
+#endif
+
+#include "../Common/PatternResultCache.hpp"
+#include "../Common/TranslationBundle.hpp"
+#include "../Common/TranslationCompiler.hpp"
+#include "../Common/TranslationLookup.hpp"
+#include "../Common/TranslationTemplates.hpp"
+#include "../Common/Utf16Transcoder.hpp"
+#include "TestUtils.hpp"
+
+using StringPairs = std::vector<std::pair<std::u16string, std::u16string>>;
+
+static TranslationEncoders makeEncoders()
+{
+	TranslationEncoders encoders;
+	encoders.toWide = [](const std::string& str) { return Utf16Transcoder::FromUtf8(str); };
+	return encoders;
+}
+
+// Bundle with one pattern file per group
+static bool loadTemplates(const std::vector<std::pair<StringPairs, StringPairs>>& groups, TranslationBundle& bundle, TranslationTemplates& templates)
+{
+	TranslationBundleBuilder builder(BundleKeyEncoding::UTF16);
+	for (const auto& [patterns, data] : groups)
+		builder.AddTemplates(patterns, data);
+
+	return bundle.Load(builder.Build()) && templates.Attach(bundle);
+}
+
+static std::u16string find(const TranslationTemplates& templates, const std::u16string& str)
+{
+	std::u16string result;
+	return templates.Find(str, result) ? result : u"<none>";
+}
+
+//
+// The pattern expansion of the old loader, which built an entry for every pattern and
+// data entry with std::vformat. Without <format> the same rules are applied by hand.
+//
+static std::u16string expandPattern(const std::u16string& pattern, const std::u16string& key, const std::u16string& value)
+{
+#ifdef __cpp_lib_format
+	const std::string utf8Key   = Utf16Transcoder::ToUtf8(key);
+	const std::string utf8Value = Utf16Transcoder::ToUtf8(value);
+	return Utf16Transcoder::FromUtf8(std::vformat(Utf16Transcoder::ToUtf8(pattern), std::make_format_args(utf8Key, utf8Value)));
+#else
+	std::u16string result;
+	std::size_t nextArg = 0;
+
+	for (std::size_t i = 0; i < pattern.size(); i++)
+	{
+		if (pattern.compare(i, 2, u"{{") == 0 || pattern.compare(i, 2, u"}}") == 0)
+			result.push_back(pattern[i++]);
+		else if (pattern.compare(i, 2, u"{}") == 0)
+		{
+			result.append(nextArg++ == 0 ? key : value);
+			i++;
+		}
+		else if (pattern.compare(i, 3, u"{0}") == 0 || pattern.compare(i, 3, u"{1}") == 0)
+		{
+			result.append(pattern[i + 1] == u'0' ? key : value);
+			i += 2;
+		}
+		else
+			result.push_back(pattern[i]);
+	}
+
+	return result;
+#endif
+}
+
+static void testPlaceholders()
+{
+	TranslationBundle bundle;
+	TranslationTemplates templates;
+	CHECK(loadTemplates({ { { { u"{}を倒した", u"Defeated {1}" },
+							  { u"{0}が現れた", u"{1} appears ({0})" },
+							  { u"{1} joined", u"{0}が仲間になった" },
+							  { u"{}は{}", u"{} is called {}" } },
+							{ { u"スライム", u"Slime" }, { u"ドラゴン", u"Dragon" } } } },
+						bundle, templates));
+	CHECK(templates.Size() == 4);
+
+	CHECK(find(templates, u"スライムを倒した") == u"Defeated Slime");
+	CHECK(find(templates, u"ドラゴンが現れた") == u"Dragon appears (ドラゴン)");
+	CHECK(find(templates, u"Slime joined") == u"スライムが仲間になった");
+	CHECK(find(templates, u"スライムはSlime") == u"スライム is called Slime");
+
+	// Unknown data entries, strings matching only a part of a pattern and the data itself
+	CHECK(find(templates, u"ゴブリンを倒した") == u"<none>");
+	CHECK(find(templates, u"スライム joined") == u"<none>");
+	CHECK(find(templates, u"スライムを倒した！") == u"<none>");
+	CHECK(find(templates, u"を倒した") == u"<none>");
+	CHECK(find(templates, u"スライム") == u"<none>");
+	CHECK(find(templates, u"") == u"<none>");
+}
+
+static void testEscapedBraces()
+{
+	TranslationBundle bundle;
+	TranslationTemplates templates;
+	CHECK(loadTemplates({ { { { u"{{{}}}を倒した", u"Defeated {{{1}}}" }, { u"}}{0}{{", u"{{}}{1}" } }, { { u"スライム", u"Slime" } } } }, bundle, templates));
+
+	CHECK(find(templates, u"{スライム}を倒した") == u"Defeated {Slime}");
+	CHECK(find(templates, u"}スライム{") == u"{}Slime");
+	CHECK(find(templates, u"スライムを倒した") == u"<none>");
+
+	const CompiledPattern pattern = compilePattern(u"{{{0}}}");
+	CHECK(pattern.literals == std::vector<std::u16string>({ u"{", u"}" }));
+	CHECK(pattern.arguments == std::vector<uint8_t>({ 0 }));
+}
+
+// The first placeholder has to be tried at every occurrence of the literal after it
+static void testRepeatedInnerLiteral()
+{
+	TranslationBundle bundle;
+	TranslationTemplates templates;
+	CHECK(loadTemplates({ { { { u"{0}と{1}", u"{0} with {1}" }, { u"{0}と{0}の戦い", u"{1} against {1}" } },
+							{ { u"AとB", u"A and B" }, { u"と", u"And" }, { u"スライム", u"Slime" } } } },
+						bundle, templates));
+
+	CHECK(find(templates, u"AとBとA and B") == u"AとB with A and B");
+	CHECK(find(templates, u"とととの戦い") == u"And against And");
+	CHECK(find(templates, u"スライムとスライムの戦い") == u"Slime against Slime");
+
+	// Both placeholders of the same data entry have to agree
+	CHECK(find(templates, u"AとBとSlime") == u"<none>");
+	CHECK(find(templates, u"スライムとととの戦い") == u"<none>");
+}
+
+// Later patterns replace earlier ones like they did as expanded entries, also across files
+static void testLatestPatternWins()
+{
+	TranslationBundle bundle;
+	TranslationTemplates templates;
+	CHECK(loadTemplates({ { { { u"{}を倒した", u"Defeated {1}" }, { u"{}を倒した", u"Beat {1}" }, { u"スライムを{}", u"Slime: {1}" } },
+							{ { u"スライム", u"Slime" }, { u"倒した", u"defeated" } } },
+						  { { { u"{}が現れた", u"{1} appeared" } }, { { u"スライム", u"Schleim" } } },
+						  { { { u"{}を倒した", u"{1} was beaten" } }, { { u"ドラゴン", u"Dragon" } } } },
+						bundle, templates));
+
+	// The third file only knows the dragon, so the slime is left to the first file
+	CHECK(find(templates, u"ドラゴンを倒した") == u"Dragon was beaten");
+	CHECK(find(templates, u"スライムを倒した") == u"Slime: defeated");
+	CHECK(find(templates, u"スライムが現れた") == u"Schleim appeared");
+}
+
+static void testInvalidPatterns()
+{
+	const auto rejects = [](const std::u16string& pattern) {
+		try
+		{
+			compilePattern(pattern);
+			return false;
+		}
+		catch (const std::runtime_error&)
+		{
+			return true;
+		}
+	};
+
+	CHECK(!rejects(u"{}と{}"));
+	CHECK(!rejects(u"{1}と{0}"));
+	CHECK(rejects(u"{}と{0}"));
+	CHECK(rejects(u"{1}と{}"));
+	CHECK(rejects(u"{}と{}と{}"));
+	CHECK(rejects(u"{2}"));
+	CHECK(rejects(u"{name}"));
+	CHECK(rejects(u"{を倒した"));
+	CHECK(rejects(u"}を倒した"));
+
+	// A catalogue with an invalid pattern does not compile
+	std::istringstream input(R"({ "patterns": { "{}と{1}": "{1}" }, "data": { "a": "b" } })");
+	TranslationBundleBuilder builder(BundleKeyEncoding::UTF16);
+	bool threw = false;
+
+	try
+	{
+		compileRedirectTranslations(input, builder, makeEncoders());
+	}
+	catch (const std::runtime_error&)
+	{
+		threw = true;
+	}
+
+	CHECK(threw);
+}
+
+// A direct translation is used before any pattern, misses are cached
+static void testLookupOrder()
+{
+	const TranslationEncoders encoders = makeEncoders();
+	TranslationBundleBuilder builder(BundleKeyEncoding::UTF16);
+
+	std::istringstream direct(R"({ "スライムを倒した": "Slime down!", "%d%%": "%d percent", "10% damage": "10% Schaden", "逃げる": "" })");
+	std::istringstream patterns(R"({ "patterns": { "{}を倒した": "Defeated {1}", "{}を使った": "{1}" }, "data": { "スライム": "Slime", "ドラゴン": "Dragon", "やくそう": "" } })");
+	compileRedirectTranslations(direct, builder, encoders);
+	compileRedirectTranslations(patterns, builder, encoders);
+
+	TranslationBundle bundle;
+	TranslationTemplates templates;
+	PatternResultCache patternResults(64);
+	CHECK(bundle.Load(builder.Build()));
+	CHECK(templates.Attach(bundle));
+
+	const auto lookup = [&](const std::u16string& key, const bool& asFormat = false) {
+		std::size_t length    = 0;
+		const char16_t* pText = lookupTranslation(bundle, templates, patternResults, key, length, asFormat);
+		return pText ? std::u16string(pText, length) : std::u16string(u"<none>");
+	};
+
+	CHECK(lookup(u"スライムを倒した") == u"Slime down!");
+	CHECK(lookup(u"ドラゴンを倒した") == u"Defeated Dragon");
+	CHECK(patternResults.Size() == 1);
+
+	// Only translations reading the arguments of the original are used as a format
+	CHECK(lookup(u"%d%%", true) == u"%d percent");
+	CHECK(lookup(u"10% damage") == u"10% Schaden");
+	CHECK(lookup(u"10% damage", true) == u"<none>");
+
+	CHECK(lookup(u"ゴブリンを倒した") == u"<none>");
+	CHECK(patternResults.Find(u"ゴブリンを倒した") == &PatternResultCache::NO_MATCH);
+	CHECK(lookup(u"ゴブリンを倒した") == u"<none>");
+	CHECK(patternResults.Size() == 2);
+
+	// Empty translations and pattern results keep the original string
+	CHECK(lookup(u"逃げる") == u"<none>");
+	CHECK(lookup(u"やくそうを使った") == u"<none>");
+	CHECK(lookup(u"スライムを使った") == u"Slime");
+
+	// The cached result is returned from then on
+	std::size_t length = 0;
+	CHECK(lookupTranslation(bundle, templates, patternResults, u"ドラゴンを倒した", length) == patternResults.Find(u"ドラゴンを倒した")->c_str());
+}
+
+// Every string the old loader expanded translates the same way
+static void testExpansionEquivalence()
+{
+	const StringPairs patterns = { { u"{}を倒した", u"Defeated {1}" },
+								   { u"{0}が{{逃げた}}", u"{1} fled ({0})" },
+								   { u"{1}の攻撃", u"{{{1}}} attacks" },
+								   { u"{0}と{1}", u"{1} and {0}" },
+								   { u"{}を倒した", u"Beat {1}" },
+								   { u"{}：{}", u"{1}: {0}" } };
+
+	const StringPairs data = { { u"スライム", u"Slime" }, { u"ドラゴン", u"Dragon" }, { u"はぐれメタル", u"Metal Slime" }, { u"キング", u"King" } };
+
+	TranslationBundle bundle;
+	TranslationTemplates templates;
+	CHECK(loadTemplates({ { patterns, data } }, bundle, templates));
+
+	std::map<std::u16string, std::u16string> expanded;
+	for (const auto& [key, value] : data)
+	{
+		for (const auto& [original, translated] : patterns)
+			expanded[expandPattern(original, key, value)] = expandPattern(translated, key, value);
+	}
+
+	CHECK(expanded.size() == (patterns.size() - 1) * data.size());
+
+	for (const auto& [key, value] : expanded)
+		CHECK(find(templates, key) == value);
+}
+
+int main()
+{
+	testPlaceholders();
+	testEscapedBraces();
+	testRepeatedInnerLiteral();
+	testLatestPatternWins();
+	testInvalidPatterns();
+	testLookupOrder();
+	testExpansionEquivalence();
+
+	return finishTests("TranslationTemplatesTests");
+}